@@ -147,7 +147,10 @@ XPluginStart(char *name, char *sig, char *desc)
 		goto errout;
 	}
 	logMsg("navaiddb_init");
-	ndb = navaiddb_create(xpdir, &adb);
+	cachedir = mkpathname(xpdir, "Output", "caches", "libradio.plugin",
+	    NULL);
+	ndb = navaiddb_create2(xpdir, cachedir, &adb);
+	lacf_free(cachedir);
 	if (ndb == NULL) {
 		logMsg("navaiddb_create failed, bailing");
 		goto errout;
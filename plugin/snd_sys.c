@@ -49,6 +49,8 @@ typedef struct {
 	unsigned	nr;
 	navrad_type_t	type;
 	unsigned	stream_id;
+	/* render buffer, so the sound worker needn't allocate any */
+	int16_t		samples[NAVRAD_AUDIO_MAX_SAMPLES];
 } radio_t;
 
 typedef enum {
@@ -253,23 +255,21 @@ radio_snd_worker(const snd_sys_t *sys, radio_t *radio)
 			ZERO_FREE(buf);
 		}
 		while (list_count(&radio->bufs) < 2) {
-			size_t num_samples;
-			int16_t *samples = navrad_get_audio_buf2(radio->type,
+			size_t num_samples = navrad_render_audio(radio->type,
 			    radio->nr, volume, radio->squelch, false,
-			    radio->stream_id, &num_samples);
+			    radio->stream_id, radio->samples,
+			    ARRAY_NUM_ELEM(radio->samples));
 			albuf_t *buf;
 
-			if (samples == NULL)
+			if (num_samples == 0)
 				break;
 			buf = safe_calloc(1, sizeof (*buf));
 			alGenBuffers(1, &buf->buf);
-			alBufferData(buf->buf, AL_FORMAT_MONO16, samples,
-			    num_samples * sizeof (*samples),
-			    NAVRAD_AUDIO_SRATE);
+			alBufferData(buf->buf, AL_FORMAT_MONO16,
+			    radio->samples, num_samples *
+			    sizeof (*radio->samples), NAVRAD_AUDIO_SRATE);
 			alSourceQueueBuffers(radio->source, 1, &buf->buf);
 			list_insert_tail(&radio->bufs, buf);
-
-			navrad_free_audio_buf(samples);
 		}
 	} else {
 		albuf_t *buf;
@@ -306,13 +306,12 @@ DISTORT_API void
 distort(distort_t *dis, int16_t *samples, size_t num_samples,
     double amplify, double noise_level)
 {
-	int16_t *out_samples = (int16_t *) calloc(num_samples,
-	    sizeof (*out_samples));
-
-	distort_impl(dis, samples, out_samples, num_samples, amplify,
+	/*
+	 * distort_impl consumes all of its input before it starts
+	 * writing any output, so it can work in place.
+	 */
+	distort_impl(dis, samples, samples, num_samples, amplify,
 	    noise_level);
-	memcpy(samples, out_samples, num_samples * sizeof (*samples));
-	free(out_samples);
 }
 
 DISTORT_API void
@@ -84,7 +84,6 @@ typedef struct {
 	char		icao[NAVAIDDB_ICAO_LEN];
 
 	geo_pos3_t	pos;
-	double		xp_elev;
 	vect3_t		ecef;
 	uint64_t	freq;
 	double		range;
@@ -108,6 +107,7 @@ typedef struct {
 			double		fcrs;		/* degrees */
 			char		rwy_id[8];
 			geo_pos3_t	corr_pos;
+			vect3_t		corr_ecef;
 			bool_t		rwy_align_done;
 		} loc;
 		struct {
@@ -145,33 +145,64 @@ typedef struct {
 			char		rwy_id[8];
 		} gls;
 	};
-
-	list_node_t	node;
-	avl_node_t	lat_node;
-	avl_node_t	lon_node;
-	avl_node_t	id_node;
-	avl_node_t	freq_node;
 } navaid_t;
 
 typedef struct {
 	const navaid_t	**navaids;
+	double		*dists;		/* meters from the query center */
 	size_t		num_navaids;
+	size_t		cap;
 } navaid_list_t;
 
+typedef bool_t (*navaiddb_visit_cb_t)(const navaid_t *nav, double dist,
+    void *userinfo);
+
+/*
+ * Creates the navaid database from X-Plane's navaid data in `xpdir'.
+ * Besides parsing the navaid files, this aligns every localizer in the
+ * world with its runway, loading each airport's tiles from `adb' (under
+ * its lock). That is the bulk of the startup cost, and navaiddb_create
+ * pays it on every call. navaiddb_create2 with a cache directory only
+ * pays it when the source data has changed, so prefer that whenever a
+ * writable cache directory is available.
+ */
 navaiddb_t *navaiddb_create(const char *xpdir, airportdb_t *adb);
+navaiddb_t *navaiddb_create2(const char *xpdir, const char *cachedir,
+    airportdb_t *adb);
 void navaiddb_destroy(navaiddb_t *db);
+size_t navaiddb_get_num_navaids(const navaiddb_t *db);
+size_t navaiddb_get_size(const navaiddb_t *db);
 
-double navaiddb_get_xp_elev(const navaid_t *nav);
+/*
+ * Probes X-Plane's scenery for the ground elevation at a navaid of `db'.
+ * The result is remembered in a per-process overlay, as the database
+ * itself is shared read-only with other processes. This uses the XPLM
+ * API, so it may only be called from the sim thread.
+ */
+double navaiddb_get_xp_elev(navaiddb_t *db, const navaid_t *nav);
 
 navaid_list_t *navaiddb_query(navaiddb_t *db, geo_pos2_t center,
     double radius, const char *id, uint64_t *freq, navaid_type_t *type);
+void navaiddb_query_list(navaiddb_t *db, geo_pos2_t center, double radius,
+    const char *id, uint64_t *freq, navaid_type_t *type, navaid_list_t *list);
+void navaiddb_query_foreach(navaiddb_t *db, geo_pos2_t center, double radius,
+    const char *id, uint64_t *freq, navaid_type_t *type,
+    navaiddb_visit_cb_t cb, void *userinfo);
+void navaiddb_query_nearest(navaiddb_t *db, geo_pos3_t center, double radius,
+    size_t k, bool_t slant, const char *id, uint64_t *freq,
+    navaid_type_t *type, navaid_list_t *list);
+size_t navaiddb_lookup_id(navaiddb_t *db, const char *id,
+    navaid_type_t *type, const char *region, const char *icao,
+    navaid_list_t *list);
 const navaid_t *navaiddb_find_conflict_same_arpt(navaiddb_t *db,
     const navaid_t *srch);
 void navaiddb_list_free(navaid_list_t *list);
+void navaiddb_list_fini(navaid_list_t *list);
 
 const char *navaid_type2str(navaid_type_t type);
 uint64_t navaid_act_freq(navaid_type_t type, uint64_t ref_freq);
 geo_pos3_t navaid_get_pos(const navaid_t *nav);
+vect3_t navaid_get_ecef(const navaid_t *nav);
 
 #ifdef	__cplusplus
 }
@@ -36,8 +36,15 @@
 extern "C" {
 #endif
 
+/*
+ * Number of VLOC and ADF radios created by navrad_init. The maximum
+ * number of DME radios which can be created by navrad_init2. Further
+ * radios can be created at runtime using navrad_add_radio, up to
+ * NAVRAD_MAX_RADIOS radios of each type.
+ */
 #define	NUM_NAV_RADIOS		2
 #define	MAX_NUM_DMES		8
+#define	NAVRAD_MAX_RADIOS	64
 #define	NAVRAD_AUDIO_SRATE	48000
 
 typedef enum {
@@ -101,6 +108,44 @@ void navrad_fini(void);
 void navrad_worker_start(void);
 void navrad_worker_stop(void);
 
+/*
+ * The database passed to navrad_init remains owned by the caller, who
+ * must not destroy it before navrad_fini, even if it has been replaced
+ * in the meantime. Databases passed to navrad_set_db (or built by
+ * navrad_reload_db) are owned by libradio.
+ */
+void navrad_set_db(navaiddb_t *db);
+bool_t navrad_reload_db(const char *xpdir, const char *cachedir,
+    airportdb_t *adb);
+
+/*
+ * Runtime radio management. Radios are identified by their type and
+ * a zero-based number (which is what all the other functions take in
+ * their `nr' argument). navrad_init creates NUM_NAV_RADIOS VLOC and
+ * ADF radios and the requested number of DMEs, but you can add and
+ * remove radios of any type and number (below NAVRAD_MAX_RADIOS) at any
+ * time from the sim thread. Removing a radio doesn't renumber the other
+ * radios, and removing a radio which doesn't exist does nothing.
+ * navrad_add_radio returns B_FALSE if the radio already exists, if `nr'
+ * is NAVRAD_MAX_RADIOS or more, or if libradio was built with
+ * USE_XPLANE_RADIO_DRS and X-Plane has no such radio to follow.
+ * navrad_get_num_radios returns one more than the highest radio number
+ * of the given type currently in existence.
+ */
+bool_t navrad_add_radio(navrad_type_t type, unsigned nr);
+void navrad_remove_radio(navrad_type_t type, unsigned nr);
+bool_t navrad_have_radio(navrad_type_t type, unsigned nr);
+unsigned navrad_get_num_radios(navrad_type_t type);
+
+/*
+ * Limits the number of candidate stations per radio and navaid type for
+ * which the signal propagation is computed to the `n' nearest ones
+ * within range. This bounds the worker's cost in areas with many
+ * navaids on the same frequency. Zero means unlimited. Default: 16.
+ */
+void navrad_set_max_candidates(unsigned n);
+unsigned navrad_get_max_candidates(void);
+
 void navrad_set_freq(navrad_type_t type, unsigned nr, uint64_t freq);
 uint64_t navrad_get_freq(navrad_type_t type, unsigned nr);
 
@@ -135,6 +180,19 @@ void navrad_set_brg_override(navrad_type_t type, unsigned nr, bool_t flag);
 bool_t navrad_get_brg_override(navrad_type_t type, unsigned nr);
 
 #define	NAVRAD_MAX_STREAMS	4
+/*
+ * Audio is rendered as NAVRAD_AUDIO_SRATE Hz mono signed 16-bit samples
+ * in native byte order, one chunk at a time. A chunk never exceeds
+ * NAVRAD_AUDIO_MAX_SAMPLES samples, so a buffer of that size can be
+ * used for all radio types. navrad_render_audio writes into a buffer
+ * provided by the caller and doesn't allocate memory, so it is the
+ * preferred interface for real-time audio threads.
+ */
+#define	NAVRAD_AUDIO_MAX_SAMPLES	4800
+size_t navrad_get_audio_num_samples(navrad_type_t type);
+size_t navrad_render_audio(navrad_type_t type, unsigned nr, double volume,
+    bool_t squelch, bool_t agc, unsigned stream_id, int16_t *buf,
+    size_t cap);
 int16_t *navrad_get_audio_buf(navrad_type_t type, unsigned nr, double volume,
     bool_t squelch, bool_t agc, size_t *num_samples);
 int16_t *navrad_get_audio_buf2(navrad_type_t type, unsigned nr, double volume,
@@ -143,7 +201,16 @@ void navrad_free_audio_buf(int16_t *buf);
 void navrad_done_audio(unsigned nr);
 void navrad_sync_streams(navrad_type_t type, unsigned nr);
 
+/*
+ * Navaid failures. The slot interface is retained for compatibility.
+ * Slots are no longer limited to NUM_NAVAID_FAILS, they are allocated
+ * on demand up to NAVAID_FAIL_MAX_SLOTS. Setting a slot beyond that is
+ * ignored. Alternatively, failures can be set directly by navaid ID
+ * and type mask. navrad_clear_navaid_fails only clears the latter kind.
+ * IDs of 8 characters or longer never match any navaid.
+ */
 #define	NUM_NAVAID_FAILS	16
+#define	NAVAID_FAIL_MAX_SLOTS	1024
 void navrad_set_navaid_fail_ID(unsigned slot, const char *name);
 void navrad_set_navaid_fail_type(unsigned slot, navaid_type_t type);
 void navrad_set_navaid_fail_state(unsigned slot, bool_t failed);
@@ -152,6 +219,11 @@ void navrad_get_navaid_fail_ID(unsigned slot, char *buf, size_t cap);
 navaid_type_t navrad_get_navaid_fail_type(unsigned slot);
 bool_t navrad_get_navaid_fail_state(unsigned slot);
 
+void navrad_set_navaid_failed(const char *ID, navaid_type_t type,
+    bool_t failed);
+bool_t navrad_get_navaid_failed(const char *ID, navaid_type_t type);
+void navrad_clear_navaid_fails(void);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -16,15 +16,27 @@
  * Copyright 2018 Saso Kiselkov. All rights reserved.
  */
 
+#include <ctype.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#if	IBM
+#include <windows.h>
+#else	/* !IBM */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif	/* !IBM */
 
 #include <XPLMGraphics.h>
 #include <XPLMScenery.h>
 
+#include <acfutils/crc64.h>
 #include <acfutils/log.h>
 #include <acfutils/helpers.h>
 #include <acfutils/htbl.h>
@@ -42,15 +54,191 @@
 #define	HZ2KHZ(freq)	(freq / 1000)
 
 #define	NAVAIDDB_HTBL_SHIFT	17
+/* Initial capacity of query result lists, which then grow on demand. */
+#define	NAVAID_LIST_INIT_CAP	64
+
+#define	GRID_LAT_CELLS	180
+#define	GRID_LON_CELLS	360
+#define	GRID_NUM_CELLS	(GRID_LAT_CELLS * GRID_LON_CELLS)
+
+/*
+ * Files larger than PARSE_MIN_CHUNK are split into chunks which are
+ * parsed in parallel by up to PARSE_MAX_THREADS threads.
+ */
+#define	PARSE_MIN_CHUNK		(256 << 10)	/* bytes */
+#define	PARSE_MAX_THREADS	8
+
+#define	NAVAIDDB_CACHE_NAME	"navaiddb.bin"
+#define	NAVAIDDB_CACHE_MAGIC	0x42444E5649444152ull	/* "RADIVNDB" */
+/* Bump this whenever the image layout or navaid_t changes. */
+#define	NAVAIDDB_CACHE_VERSION	6
+
+/*
+ * Source files. The navaid sources come in order of user preference.
+ * Since the first navaid candidate found wins, they must be parsed in
+ * this order.
+ */
+enum {
+	SRC_USER_NAV,		/* Custom Data/user_nav.dat */
+	SRC_GATEWAY_LOC,	/* Global Airports hand-placed localizers */
+	SRC_CUSTOM_DATA,	/* Custom Data/earth_nav.dat */
+	SRC_DEFAULT_DATA,	/* Resources/default data/earth_nav.dat */
+	/*
+	 * Not parsed by us, but the cached localizer alignments depend
+	 * on the runways in them.
+	 */
+	SRC_GATEWAY_APT,	/* Global Airports apt.dat */
+	SRC_DEFAULT_APT,	/* default scenery apt.dat */
+	SRC_SCENERY_PACKS,	/* scenery_packs.ini & the packs' apt.dat */
+	NUM_SRCS
+};
+
+/*
+ * Identity of a source file, used to validate the cache. `path_hash'
+ * is the CRC64 of the path name, `size' is -1 if the file doesn't exist.
+ */
+typedef struct {
+	uint64_t	path_hash;
+	int64_t		size;
+	int64_t		mtime;
+} navaiddb_src_t;
+
+/*
+ * The loaded database is a single position-independent image, so that
+ * it can be written out to the cache as-is and later mapped back into
+ * memory without any parsing. The image starts with this header, which
+ * is followed by the navaid array and the index arrays at the given
+ * (8-byte aligned) offsets. The indexes refer to navaids by their index
+ * in the navaid array.
+ */
+typedef struct {
+	uint64_t	magic;
+	uint32_t	version;
+	uint32_t	navaid_sz;
+	navaiddb_src_t	srcs[NUM_SRCS];
+	uint64_t	total_sz;
+	uint64_t	num_navaids;
+	uint64_t	num_by_arpt;
+	uint64_t	navaids_off;
+	uint64_t	grid_start_off;
+	uint64_t	hot_off;
+	uint64_t	by_freq_off;
+	uint64_t	by_arpt_off;
+	uint64_t	by_id_off;
+} navaiddb_hdr_t;
+
+/*
+ * Compact copy of the navaid_t fields which the spatial and frequency
+ * indexes are scanned by. The full navaid is at navaids[idx].
+ */
+typedef struct {
+	geo_pos2_t	pos;
+	uint32_t	freq;
+	uint32_t	idx;
+	uint32_t	type;		/* navaid_type_t */
+	float		range;		/* meters */
+} navaid_hot_t;
+CTASSERT(sizeof (navaid_hot_t) == 32);
+
+/* A read-only mapping of an entire file. */
+typedef struct {
+	void		*base;
+	size_t		sz;
+#if	IBM
+	HANDLE		handle;
+#endif
+} file_map_t;
 
 struct navaiddb_s {
-	list_t		navaids;
 	airportdb_t	*adb;
+
+	/*
+	 * Either a malloc'd image or a read-only mapping of the cache
+	 * file. The mapping is shared with all other processes which use
+	 * the same cache directory, so the image must never be written to
+	 * once it has been built.
+	 */
+	navaiddb_hdr_t	*hdr;
+	bool_t		mapped;
+	file_map_t	map;
+	/*
+	 * Per-process overlay of X-Plane scenery elevations, indexed like
+	 * `navaids'. Allocated on first use by navaiddb_get_xp_elev.
+	 */
+	double		*xp_elev;
+
+	navaid_t	*navaids;
+	size_t		num_navaids;
+	/*
+	 * Immutable spatial index. The globe is split into 1x1 degree
+	 * cells. `hot' holds a compact record of every navaid, sorted by
+	 * cell, and the navaids in cell `c' are hot[grid_start[c]] up to
+	 * (but excluding) hot[grid_start[c + 1]]. Queries thus scan
+	 * contiguous memory and only touch the full navaid_t of matches.
+	 */
+	const navaid_hot_t	*hot;
+	const uint32_t	*grid_start;
+	/*
+	 * Indexes into `hot', sorted by frequency and type. Queries which
+	 * specify a frequency only need to look at the matching run of
+	 * this array, which is usually only a few dozen navaids worldwide.
+	 */
+	const uint32_t	*by_freq;
+	/*
+	 * Navaids associated with an airport, sorted by type and airport
+	 * ICAO code.
+	 */
+	const uint32_t	*by_arpt;
+	size_t		num_by_arpt;
+	/* All navaids sorted by identifier and type. */
+	const uint32_t	*by_id;
+};
+
+/*
+ * A navaid while it is being parsed. `nav' must come first, so that a
+ * navaid_t pointer to it can be freed directly.
+ */
+typedef struct {
+	navaid_t	nav;
+	list_node_t	node;
+	avl_node_t	lat_node;
+	avl_node_t	lon_node;
+	avl_node_t	id_node;
+} parse_nav_t;
+
+/*
+ * State only needed while parsing the source files. The trees and the
+ * hash table are only used to weed out duplicate navaids.
+ */
+typedef struct {
+	list_t		navaids;
 	avl_tree_t	lat;
 	avl_tree_t	lon;
 	avl_tree_t	by_id;
 	htbl_t		by_arpt;
-};
+} navaiddb_parse_t;
+
+static inline int
+grid_lat_idx(double lat)
+{
+	return (clampi(floor(lat + 90), 0, GRID_LAT_CELLS - 1));
+}
+
+static inline int
+grid_lon_idx(double lon)
+{
+	int idx = (int)floor(lon + 180) % GRID_LON_CELLS;
+
+	if (idx < 0)
+		idx += GRID_LON_CELLS;
+	return (idx);
+}
+
+static inline unsigned
+grid_cell(geo_pos2_t pos)
+{
+	return (grid_lat_idx(pos.lat) * GRID_LON_CELLS + grid_lon_idx(pos.lon));
+}
 
 static inline int
 common_latlon_compar(const void *a, const void *b, double pa, double pb)
@@ -123,25 +311,568 @@ lon_compar(const void *a, const void *b)
 }
 
 static void
-navaids_flush(navaiddb_t *db)
+parse_init(navaiddb_parse_t *ps)
+{
+	list_create(&ps->navaids, sizeof (parse_nav_t),
+	    offsetof(parse_nav_t, node));
+	avl_create(&ps->lat, lat_compar,
+	    sizeof (parse_nav_t), offsetof(parse_nav_t, lat_node));
+	avl_create(&ps->lon, lon_compar,
+	    sizeof (parse_nav_t), offsetof(parse_nav_t, lon_node));
+	avl_create(&ps->by_id, id_compar,
+	    sizeof (parse_nav_t), offsetof(parse_nav_t, id_node));
+	htbl_create(&ps->by_arpt, 1 << NAVAIDDB_HTBL_SHIFT,
+	    /*
+	     * Use the concatenated representation of the `type' and `icao'
+	     * fields as the hash table key.
+	     */
+	    ((offsetof(navaid_t, icao) + NAVAIDDB_ICAO_LEN) -
+	    offsetof(navaid_t, type)), B_TRUE);
+}
+
+static void
+parse_flush(navaiddb_parse_t *ps)
 {
 	void *cookie;
 	navaid_t *navaid;
 
 	cookie = NULL;
-	while (avl_destroy_nodes(&db->lat, &cookie) != NULL)
+	while (avl_destroy_nodes(&ps->lat, &cookie) != NULL)
 		;
 	cookie = NULL;
-	while (avl_destroy_nodes(&db->lon, &cookie) != NULL)
+	while (avl_destroy_nodes(&ps->lon, &cookie) != NULL)
 		;
 	cookie = NULL;
-	while (avl_destroy_nodes(&db->by_id, &cookie) != NULL)
+	while (avl_destroy_nodes(&ps->by_id, &cookie) != NULL)
 		;
-	htbl_empty(&db->by_arpt, NULL, NULL);
-	while ((navaid = list_remove_head(&db->navaids)) != NULL)
+	htbl_empty(&ps->by_arpt, NULL, NULL);
+	while ((navaid = list_remove_head(&ps->navaids)) != NULL)
 		free(navaid);
 }
 
+static void
+parse_fini(navaiddb_parse_t *ps)
+{
+	parse_flush(ps);
+	avl_destroy(&ps->lat);
+	avl_destroy(&ps->lon);
+	avl_destroy(&ps->by_id);
+	htbl_destroy(&ps->by_arpt);
+	list_destroy(&ps->navaids);
+}
+
+static inline bool_t
+navaid_is_arpt(const navaid_t *nav)
+{
+	return (nav->icao[0] != '\0' && strcmp(nav->icao, "ENRT") != 0);
+}
+
+/*
+ * Points the database at the navaid and index arrays of its image.
+ */
+static void
+image_setup(navaiddb_t *db)
+{
+	uint8_t *base = (uint8_t *)db->hdr;
+
+	db->navaids = (navaid_t *)(base + db->hdr->navaids_off);
+	db->num_navaids = db->hdr->num_navaids;
+	db->hot = (const navaid_hot_t *)(base + db->hdr->hot_off);
+	db->grid_start = (const uint32_t *)(base + db->hdr->grid_start_off);
+	db->by_freq = (const uint32_t *)(base + db->hdr->by_freq_off);
+	db->by_arpt = (const uint32_t *)(base + db->hdr->by_arpt_off);
+	db->num_by_arpt = db->hdr->num_by_arpt;
+	db->by_id = (const uint32_t *)(base + db->hdr->by_id_off);
+}
+
+/*
+ * Sort records for building the index arrays. Each record carries a copy
+ * of its sort key, so the comparators don't need any shared context and
+ * several images can be built concurrently (e.g. by navrad_reload_db on
+ * a background thread while the host creates a database of its own).
+ */
+typedef struct {
+	uint32_t	freq;
+	uint32_t	type;
+	uint32_t	idx;
+} freq_sort_t;
+
+typedef struct {
+	char		key[NAVAIDDB_ID_LEN];	/* identifier or ICAO code */
+	uint32_t	type;
+	uint32_t	idx;
+} str_sort_t;
+
+static int
+freq_sort_compar(const void *a, const void *b)
+{
+	const freq_sort_t *ka = a, *kb = b;
+
+	if (ka->freq < kb->freq)
+		return (-1);
+	if (ka->freq > kb->freq)
+		return (1);
+	if (ka->type < kb->type)
+		return (-1);
+	if (ka->type > kb->type)
+		return (1);
+	return (0);
+}
+
+static int
+id_sort_compar(const void *a, const void *b)
+{
+	const str_sort_t *ka = a, *kb = b;
+	int res = strcmp(ka->key, kb->key);
+
+	if (res != 0)
+		return (res);
+	if (ka->type < kb->type)
+		return (-1);
+	if (ka->type > kb->type)
+		return (1);
+	return (0);
+}
+
+static int
+arpt_sort_compar(const void *a, const void *b)
+{
+	const str_sort_t *ka = a, *kb = b;
+
+	if (ka->type < kb->type)
+		return (-1);
+	if (ka->type > kb->type)
+		return (1);
+	return (strcmp(ka->key, kb->key));
+}
+
+static void
+str_sort_init(str_sort_t *k, const char *key, navaid_type_t type,
+    size_t idx)
+{
+	strlcpy(k->key, key, sizeof (k->key));
+	k->type = type;
+	k->idx = idx;
+}
+
+static inline size_t
+image_align(size_t off)
+{
+	return ((off + 7) & ~(size_t)7);
+}
+
+/*
+ * Builds the database image from the parsed navaids.
+ */
+static void
+image_build(navaiddb_t *db, navaiddb_parse_t *ps,
+    const navaiddb_src_t srcs[NUM_SRCS])
+{
+	size_t n = list_count(&ps->navaids), n_arpt = 0, i, off;
+	navaiddb_hdr_t *hdr;
+	navaid_t *navaids;
+	navaid_hot_t *hot;
+	uint32_t *grid_start, *by_freq, *by_arpt, *by_id, *fill;
+	freq_sort_t *freq_keys;
+	str_sort_t *str_keys;
+
+	VERIFY3U(n, <, UINT32_MAX);
+	for (const navaid_t *nav = list_head(&ps->navaids); nav != NULL;
+	    nav = list_next(&ps->navaids, nav)) {
+		if (navaid_is_arpt(nav))
+			n_arpt++;
+	}
+
+	off = image_align(sizeof (*hdr));
+	hdr = safe_calloc(1, sizeof (*hdr));
+	hdr->navaids_off = off;
+	off = image_align(off + n * sizeof (navaid_t));
+	hdr->hot_off = off;
+	off = image_align(off + n * sizeof (navaid_hot_t));
+	hdr->grid_start_off = off;
+	off = image_align(off + (GRID_NUM_CELLS + 1) * sizeof (uint32_t));
+	hdr->by_freq_off = off;
+	off = image_align(off + n * sizeof (uint32_t));
+	hdr->by_arpt_off = off;
+	off = image_align(off + n_arpt * sizeof (uint32_t));
+	hdr->by_id_off = off;
+	off = image_align(off + n * sizeof (uint32_t));
+	hdr->total_sz = off;
+	hdr->magic = NAVAIDDB_CACHE_MAGIC;
+	hdr->version = NAVAIDDB_CACHE_VERSION;
+	hdr->navaid_sz = sizeof (navaid_t);
+	memcpy(hdr->srcs, srcs, sizeof (hdr->srcs));
+	hdr->num_navaids = n;
+	hdr->num_by_arpt = n_arpt;
+
+	db->hdr = safe_realloc(hdr, hdr->total_sz);
+	memset((uint8_t *)db->hdr + sizeof (*hdr), 0,
+	    db->hdr->total_sz - sizeof (*hdr));
+	db->mapped = B_FALSE;
+	image_setup(db);
+
+	navaids = db->navaids;
+	hot = (navaid_hot_t *)db->hot;
+	grid_start = (uint32_t *)db->grid_start;
+	by_freq = (uint32_t *)db->by_freq;
+	by_arpt = (uint32_t *)db->by_arpt;
+	by_id = (uint32_t *)db->by_id;
+
+	i = 0;
+	for (const navaid_t *nav = list_head(&ps->navaids); nav != NULL;
+	    nav = list_next(&ps->navaids, nav), i++)
+		navaids[i] = *nav;
+
+	/* spatial index */
+	for (i = 0; i < n; i++)
+		grid_start[grid_cell(GEO3_TO_GEO2(navaids[i].pos)) + 1]++;
+	for (unsigned c = 0; c < GRID_NUM_CELLS; c++)
+		grid_start[c + 1] += grid_start[c];
+	ASSERT3U(grid_start[GRID_NUM_CELLS], ==, n);
+	fill = safe_malloc(GRID_NUM_CELLS * sizeof (*fill));
+	memcpy(fill, grid_start, GRID_NUM_CELLS * sizeof (*fill));
+	for (i = 0; i < n; i++) {
+		const navaid_t *nav = &navaids[i];
+		unsigned cell = grid_cell(GEO3_TO_GEO2(nav->pos));
+		navaid_hot_t *h = &hot[fill[cell]++];
+
+		ASSERT3U(nav->freq, <=, UINT32_MAX);
+		h->pos = GEO3_TO_GEO2(nav->pos);
+		h->freq = nav->freq;
+		h->idx = i;
+		h->type = nav->type;
+		h->range = nav->range;
+	}
+	free(fill);
+
+	/* frequency index, which refers to the hot records */
+	freq_keys = safe_malloc(n * sizeof (*freq_keys));
+	for (i = 0; i < n; i++) {
+		freq_keys[i].freq = hot[i].freq;
+		freq_keys[i].type = hot[i].type;
+		freq_keys[i].idx = i;
+	}
+	qsort(freq_keys, n, sizeof (*freq_keys), freq_sort_compar);
+	for (i = 0; i < n; i++)
+		by_freq[i] = freq_keys[i].idx;
+	free(freq_keys);
+
+	/* identifier & airport indexes */
+	str_keys = safe_malloc(n * sizeof (*str_keys));
+	for (i = 0; i < n; i++)
+		str_sort_init(&str_keys[i], navaids[i].id, navaids[i].type, i);
+	qsort(str_keys, n, sizeof (*str_keys), id_sort_compar);
+	for (i = 0; i < n; i++)
+		by_id[i] = str_keys[i].idx;
+	n_arpt = 0;
+	for (i = 0; i < n; i++) {
+		if (navaid_is_arpt(&navaids[i])) {
+			str_sort_init(&str_keys[n_arpt++], navaids[i].icao,
+			    navaids[i].type, i);
+		}
+	}
+	ASSERT3U(n_arpt, ==, db->num_by_arpt);
+	qsort(str_keys, n_arpt, sizeof (*str_keys), arpt_sort_compar);
+	for (i = 0; i < n_arpt; i++)
+		by_arpt[i] = str_keys[i].idx;
+	free(str_keys);
+}
+
+/*
+ * Maps all of `path' read-only into memory. Empty files can't be mapped.
+ */
+static bool_t
+file_map(const char *path, file_map_t *map)
+{
+#if	IBM
+	HANDLE fh;
+	LARGE_INTEGER li;
+
+	memset(map, 0, sizeof (*map));
+	fh = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+	    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fh == INVALID_HANDLE_VALUE)
+		return (B_FALSE);
+	if (!GetFileSizeEx(fh, &li) || li.QuadPart <= 0) {
+		CloseHandle(fh);
+		return (B_FALSE);
+	}
+	map->sz = li.QuadPart;
+	map->handle = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(fh);
+	if (map->handle == NULL)
+		return (B_FALSE);
+	map->base = MapViewOfFile(map->handle, FILE_MAP_READ, 0, 0, 0);
+	if (map->base == NULL) {
+		CloseHandle(map->handle);
+		return (B_FALSE);
+	}
+#else	/* !IBM */
+	int fd = open(path, O_RDONLY);
+	struct stat st;
+
+	memset(map, 0, sizeof (*map));
+	if (fd == -1)
+		return (B_FALSE);
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		return (B_FALSE);
+	}
+	map->sz = st.st_size;
+	map->base = mmap(NULL, map->sz, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map->base == MAP_FAILED) {
+		map->base = NULL;
+		return (B_FALSE);
+	}
+#endif	/* !IBM */
+	return (B_TRUE);
+}
+
+static void
+file_unmap(file_map_t *map)
+{
+	if (map->base == NULL)
+		return;
+#if	IBM
+	UnmapViewOfFile(map->base);
+	CloseHandle(map->handle);
+#else	/* !IBM */
+	munmap(map->base, map->sz);
+#endif	/* !IBM */
+	map->base = NULL;
+}
+
+static void
+image_free(navaiddb_t *db)
+{
+	if (db->hdr == NULL)
+		return;
+	if (db->mapped) {
+		file_unmap(&db->map);
+	} else {
+		free(db->hdr);
+	}
+	db->hdr = NULL;
+}
+
+static void
+src_ident(const char *path, navaiddb_src_t *src)
+{
+	struct stat st;
+
+	memset(src, 0, sizeof (*src));
+	src->path_hash = crc64(path, strlen(path));
+	if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+		src->size = st.st_size;
+		src->mtime = st.st_mtime;
+	} else {
+		src->size = -1;
+	}
+}
+
+/*
+ * Identifies scenery_packs.ini at `path', along with the apt.dat files
+ * of all the scenery packs enabled in it, which airportdb reads in
+ * addition to the default and Global Airports apt.dat files. The
+ * identities of the packs' apt.dat files are folded into `path_hash',
+ * so adding, removing, reordering or updating any pack invalidates the
+ * cached localizer alignments.
+ */
+static void
+src_ident_packs(const char *xpdir, const char *path, navaiddb_src_t *src)
+{
+	FILE *fp;
+	char *line = NULL;
+	size_t cap = 0;
+
+	src_ident(path, src);
+	if (src->size < 0 || (fp = fopen(path, "r")) == NULL)
+		return;
+	while (lacf_getline(&line, &cap, fp) > 0) {
+		const char *dir;
+		char *apt_path;
+		struct {
+			uint64_t	prev_hash;
+			navaiddb_src_t	apt;
+		} h;
+
+		strip_space(line);
+		if (strncmp(line, "SCENERY_PACK ", 13) != 0)
+			continue;
+		dir = &line[13];
+		if (dir[0] == '/' || dir[0] == '\\' ||
+		    (isalpha(dir[0]) && dir[1] == ':')) {
+			apt_path = mkpathname(dir, "Earth nav data", "apt.dat",
+			    NULL);
+		} else {
+			apt_path = mkpathname(xpdir, dir, "Earth nav data",
+			    "apt.dat", NULL);
+		}
+		h.prev_hash = src->path_hash;
+		src_ident(apt_path, &h.apt);
+		src->path_hash = crc64(&h, sizeof (h));
+		lacf_free(apt_path);
+	}
+	free(line);
+	fclose(fp);
+}
+
+/*
+ * Checks that all `count' indexes in `idx' are below `limit'.
+ */
+static bool_t
+image_idx_valid(const uint32_t *idx, size_t count, uint64_t limit)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (idx[i] >= limit)
+			return (B_FALSE);
+	}
+	return (B_TRUE);
+}
+
+/*
+ * Checks that a mapped image is sane and was built from exactly the
+ * source files identified by `srcs'. Besides the layout, this also
+ * range-checks every index in the image, so that a damaged cache is
+ * rejected up front instead of making the queries read out of bounds.
+ */
+static bool_t
+image_validate(const navaiddb_hdr_t *hdr, size_t sz,
+    const navaiddb_src_t srcs[NUM_SRCS])
+{
+	const uint8_t *base = (const uint8_t *)hdr;
+	const navaid_hot_t *hot;
+	const uint32_t *grid_start;
+	uint64_t n;
+
+	if (sz < sizeof (*hdr) || hdr->magic != NAVAIDDB_CACHE_MAGIC ||
+	    hdr->version != NAVAIDDB_CACHE_VERSION ||
+	    hdr->navaid_sz != sizeof (navaid_t) || hdr->total_sz != sz ||
+	    memcmp(hdr->srcs, srcs, sizeof (hdr->srcs)) != 0)
+		return (B_FALSE);
+	n = hdr->num_navaids;
+	if (n >= UINT32_MAX || hdr->num_by_arpt > n)
+		return (B_FALSE);
+#define	CHECK_ARRAY(off, elem_sz, count) \
+	do { \
+		if ((off) % 8 != 0 || (off) > sz || \
+		    (count) > (sz - (off)) / (elem_sz)) \
+			return (B_FALSE); \
+	} while (0)
+	CHECK_ARRAY(hdr->navaids_off, sizeof (navaid_t), n);
+	CHECK_ARRAY(hdr->hot_off, sizeof (navaid_hot_t), n);
+	CHECK_ARRAY(hdr->grid_start_off, sizeof (uint32_t), GRID_NUM_CELLS + 1);
+	CHECK_ARRAY(hdr->by_freq_off, sizeof (uint32_t), n);
+	CHECK_ARRAY(hdr->by_arpt_off, sizeof (uint32_t), hdr->num_by_arpt);
+	CHECK_ARRAY(hdr->by_id_off, sizeof (uint32_t), n);
+#undef	CHECK_ARRAY
+
+	hot = (const navaid_hot_t *)(base + hdr->hot_off);
+	for (uint64_t i = 0; i < n; i++) {
+		if (hot[i].idx >= n)
+			return (B_FALSE);
+	}
+	grid_start = (const uint32_t *)(base + hdr->grid_start_off);
+	if (grid_start[0] != 0 || grid_start[GRID_NUM_CELLS] != n)
+		return (B_FALSE);
+	for (unsigned c = 0; c < GRID_NUM_CELLS; c++) {
+		if (grid_start[c] > grid_start[c + 1])
+			return (B_FALSE);
+	}
+	if (!image_idx_valid((const uint32_t *)(base + hdr->by_freq_off),
+	    n, n) ||
+	    !image_idx_valid((const uint32_t *)(base + hdr->by_arpt_off),
+	    hdr->num_by_arpt, n) ||
+	    !image_idx_valid((const uint32_t *)(base + hdr->by_id_off),
+	    n, n))
+		return (B_FALSE);
+
+	return (B_TRUE);
+}
+
+/*
+ * Attempts to load the database image from the cache file. The file is
+ * mapped read-only and shared, so any number of simulator and tool
+ * processes using the same cache directory share a single copy of the
+ * database in the page cache.
+ */
+static bool_t
+cache_load(navaiddb_t *db, const char *path,
+    const navaiddb_src_t srcs[NUM_SRCS])
+{
+	file_map_t map;
+
+	if (!file_map(path, &map))
+		return (B_FALSE);
+	if (!image_validate(map.base, map.sz, srcs)) {
+		file_unmap(&map);
+		return (B_FALSE);
+	}
+	db->hdr = map.base;
+	db->map = map;
+	db->mapped = B_TRUE;
+	image_setup(db);
+
+	return (B_TRUE);
+}
+
+/*
+ * Writes the database image out to the cache. The image is written to
+ * a temporary file first and then renamed, so that a concurrently
+ * starting simulator never sees a half-written cache. The temporary
+ * file name contains our process ID and a per-process sequence number,
+ * as several processes (and several threads within one process, e.g.
+ * navrad_reload_db running next to a navaiddb_create2 by the host)
+ * might be rebuilding the same cache at the same time. Processes which
+ * still have an older cache file mapped keep using it undisturbed
+ * (except on Windows, which refuses to replace mapped files, in which
+ * case the old cache is simply left in place).
+ */
+static bool_t
+cache_write(const navaiddb_t *db, const char *cachedir, const char *path)
+{
+	static _Atomic unsigned seq = 0;
+	char *tmppath;
+	unsigned long pid;
+	FILE *fp;
+	bool_t ok;
+
+	if (!create_directory_recursive(cachedir))
+		return (B_FALSE);
+#if	IBM
+	pid = GetCurrentProcessId();
+#else
+	pid = getpid();
+#endif
+	tmppath = sprintf_alloc("%s.%lu.%u.tmp", path, pid,
+	    atomic_fetch_add(&seq, 1));
+	fp = fopen(tmppath, "wb");
+	if (fp == NULL) {
+		logMsg("Error writing navaid cache %s: %s", tmppath,
+		    strerror(errno));
+		free(tmppath);
+		return (B_FALSE);
+	}
+	ok = (fwrite(db->hdr, 1, db->hdr->total_sz, fp) == db->hdr->total_sz);
+	ok = (fclose(fp) == 0 && ok);
+	if (ok) {
+#if	IBM
+		/* rename() on Windows refuses to replace files */
+		remove_file(path, B_TRUE);
+#endif
+		ok = (rename(tmppath, path) == 0);
+	}
+	if (!ok) {
+		logMsg("Error writing navaid cache %s: %s", path,
+		    strerror(errno));
+		remove_file(tmppath, B_TRUE);
+	}
+	free(tmppath);
+
+	return (ok);
+}
+
 static void
 my_strncat(char *buf, const char *append, size_t cap)
 {
@@ -173,12 +904,11 @@ parse_navaid_common(char **comps, size_t n_comps, navaid_type_t type,
 	if (n_comps < min_n_comps)
 		return (NULL);
 
-	nav = safe_calloc(1, sizeof (*nav));
+	nav = safe_calloc(1, sizeof (parse_nav_t));
 	nav->type = type;
 	nav->pos.lat = atof(comps[1]);
 	nav->pos.lon = atof(comps[2]);
 	nav->pos.elev = FEET2MET(atoi(comps[3]));
-	nav->xp_elev = NAN;
 	if (type == NAVAID_NDB) {
 		nav->freq = atoll(comps[4]) * 1000;
 	} else if (type == NAVAID_VOR || type == NAVAID_LOC ||
@@ -545,14 +1275,14 @@ is_navaid_conflict(navaid_t *nav, navaid_t *nav2)
  * No other navaids can be duplicate.
  */
 static void
-replace_arpt_navaid_duplicate(navaiddb_t *db, navaid_t *nav)
+replace_arpt_navaid_duplicate(navaiddb_parse_t *ps, navaid_t *nav)
 {
 	const list_t *l;
 
-	ASSERT(db != NULL);
+	ASSERT(ps != NULL);
 	ASSERT(nav != NULL);
 
-	l = htbl_lookup_multi(&db->by_arpt, &nav->type);
+	l = htbl_lookup_multi(&ps->by_arpt, &nav->type);
 	if (l != NULL) {
 		/* Remove any too-similar-looking navaids at this airport */
 		for (void *v = list_head(l), *v_next = NULL;
@@ -568,11 +1298,11 @@ replace_arpt_navaid_duplicate(navaiddb_t *db, navaid_t *nav)
 			ASSERT0(strcmp(nav->icao, nav2->icao));
 
 			if (is_navaid_conflict(nav, nav2)) {
-				avl_remove(&db->by_id, nav2);
-				avl_remove(&db->lat, nav2);
-				avl_remove(&db->lon, nav2);
-				list_remove(&db->navaids, nav2);
-				htbl_remove_multi(&db->by_arpt, &nav2->type, v);
+				avl_remove(&ps->by_id, nav2);
+				avl_remove(&ps->lat, nav2);
+				avl_remove(&ps->lon, nav2);
+				list_remove(&ps->navaids, nav2);
+				htbl_remove_multi(&ps->by_arpt, &nav2->type, v);
 				free(nav2);
 				/*
 				 * Through the transitive property of
@@ -586,161 +1316,396 @@ replace_arpt_navaid_duplicate(navaiddb_t *db, navaid_t *nav)
 			}
 		}
 	}
-	htbl_set(&db->by_arpt, &nav->type, nav);
+	htbl_set(&ps->by_arpt, &nav->type, nav);
 }
 
 /*
- * Parses an earth_nav.dat file.
- * If `replace_freq' is true, if a duplicate navaid is found, we overwrite
- * its frequency with what we've read. This is to deal with the dickish
- * situation with hand-placed localizers, which override a localizer's
- * position but NOT its frequency. The frequencies are primarily in Custom
- * Data take priority.
+ * Adds a freshly parsed navaid to the parse state, unless it duplicates
+ * a navaid we already know about. Since the first navaid candidate found
+ * wins, navaids must be inserted in order of user preference and in the
+ * order in which they appear in their source file.
  */
-static bool_t
-parse_earth_nav(navaiddb_t *db, const char *filename, bool_t replace_freq)
+static void
+parse_insert(navaiddb_parse_t *ps, navaid_t *nav, bool_t replace_freq)
 {
-	FILE *fp = fopen(filename, "rb");
-	int version = 0;
-	char *line = NULL;
-	size_t cap = 0;
+	navaid_t *other_nav;
+	avl_index_t where_id, where_lat, where_lon;
 
-	if (fp == NULL) {
-		logMsg("Error reading %s: %s", filename, strerror(errno));
-		goto errout;
-	}
-	if (fscanf(fp, "I %d", &version) != 1 ||
-	    version < EARTH_NAV_MIN_VERSION ||
-	    version < EARTH_NAV_MAX_VERSION) {
-		logMsg("Error reading %s: file malformed or version %d not "
-		    "supported", filename, version);
-		goto errout;
+	/*
+	 * Due to airport naming and region naming
+	 * inconsistencies, we might not find the
+	 * navaid duplicated in the by-id database.
+	 * So use the positional exclusion system
+	 * as well. It's dumb, but those guys can
+	 * go fix their database entries themselves.
+	 */
+	other_nav = avl_find(&ps->by_id, nav, &where_id);
+	if (other_nav == NULL)
+		other_nav = avl_find(&ps->lat, nav, &where_lat);
+	if (other_nav == NULL)
+		other_nav = avl_find(&ps->lon, nav, &where_lon);
+	if (other_nav != NULL) {
+		/*
+		 * Because of how garbage the X-Plane navaid
+		 * database is, there can be localizers in the
+		 * hand-placed localizer list with BAD freq's.
+		 * So to work around that, we replace their
+		 * frequencies from the navdata.
+		 */
+		if (replace_freq)
+			other_nav->freq = nav->freq;
+		free(nav);
+		return;
 	}
+	avl_insert(&ps->by_id, nav, where_id);
+	avl_insert(&ps->lat, nav, where_lat);
+	avl_insert(&ps->lon, nav, where_lon);
+	list_insert_tail(&ps->navaids, nav);
+	if (navaid_is_arpt(nav))
+		replace_arpt_navaid_duplicate(ps, nav);
+}
 
-	while (!feof(fp)) {
-		if (fgetc(fp) == '\n')
-			break;
-	}
+/*
+ * A line-aligned chunk of an earth_nav.dat file. The chunks are parsed
+ * into navaid records in parallel, which are collected in file order
+ * in `navs'.
+ */
+typedef struct {
+	const char	*start;
+	const char	*end;
+	navaid_t	**navs;
+	size_t		num_navs;
+	size_t		cap;
+	thread_t	thr;
+} parse_chunk_t;
+
+static void
+parse_chunk(void *arg)
+{
+	parse_chunk_t *chunk = arg;
+	char *line = NULL;
+	size_t line_cap = 0;
 
-	while (getline(&line, &cap, fp) > 0) {
+	for (const char *p = chunk->start; p < chunk->end;) {
+		const char *eol = memchr(p, '\n', chunk->end - p);
 		navaid_t *nav;
+		size_t len;
+
+		if (eol == NULL)
+			eol = chunk->end;
+		len = eol - p;
+		/* parse_line modifies the line, so copy it out of the map */
+		if (len + 1 > line_cap) {
+			line_cap = len + 1;
+			line = safe_realloc(line, line_cap);
+		}
+		memcpy(line, p, len);
+		line[len] = '\0';
+		p = (eol < chunk->end ? eol + 1 : eol);
 
-		if (!parse_line(line, &nav))
+		if (!parse_line(line, &nav) || nav == NULL)
 			continue;
+		if (chunk->num_navs == chunk->cap) {
+			chunk->cap = MAX(2 * chunk->cap, 1024);
+			chunk->navs = safe_realloc(chunk->navs,
+			    chunk->cap * sizeof (*chunk->navs));
+		}
+		chunk->navs[chunk->num_navs++] = nav;
+	}
+	free(line);
+}
 
-		if (nav != NULL) {
-			navaid_t *other_nav;
-			avl_index_t where_id, where_lat, where_lon;
-			/*
-			 * Due to airport naming and region naming
-			 * inconsistencies, we might not find the
-			 * navaid duplicated in the by-id database.
-			 * So use the positional exclusion system
-			 * as well. It's dumb, but those guys can
-			 * go fix their database entries themselves.
-			 */
-			other_nav = avl_find(&db->by_id, nav, &where_id);
-			if (other_nav == NULL)
-				other_nav = avl_find(&db->lat, nav, &where_lat);
-			if (other_nav == NULL)
-				other_nav = avl_find(&db->lon, nav, &where_lon);
-			if (other_nav != NULL) {
-				/*
-				 * Because of how garbage the X-Plane navaid
-				 * database is, there can be localizers in the
-				 * hand-placed localizer list with BAD freq's.
-				 * So to work around that, we replace their
-				 * frequencies from the navdata.
-				 */
-				if (replace_freq)
-					other_nav->freq = nav->freq;
-				free(nav);
-				continue;
-			}
-			avl_insert(&db->by_id, nav, where_id);
-			avl_insert(&db->lat, nav, where_lat);
-			avl_insert(&db->lon, nav, where_lon);
-			list_insert_tail(&db->navaids, nav);
-			if (nav->icao[0] != '\0' &&
-			    strcmp(nav->icao, "ENRT") != 0) {
-				replace_arpt_navaid_duplicate(db, nav);
-			}
+/* Number of threads to use for parsing a large earth_nav.dat file. */
+static size_t
+parse_num_threads(void)
+{
+#if	IBM
+	SYSTEM_INFO si;
+
+	GetSystemInfo(&si);
+	return (clampi(si.dwNumberOfProcessors, 1, PARSE_MAX_THREADS));
+#else	/* !IBM */
+	return (clampi(sysconf(_SC_NPROCESSORS_ONLN), 1, PARSE_MAX_THREADS));
+#endif	/* !IBM */
+}
+
+/*
+ * Parses an earth_nav.dat file.
+ * If `replace_freq' is true, if a duplicate navaid is found, we overwrite
+ * its frequency with what we've read. This is to deal with the dickish
+ * situation with hand-placed localizers, which override a localizer's
+ * position but NOT its frequency. The frequencies are primarily in Custom
+ * Data take priority.
+ *
+ * The file is mapped into memory and split into line-aligned chunks,
+ * which are parsed into navaid records in parallel. The records are then
+ * merged into the parse state sequentially in file order, so the result
+ * is exactly the same as if the file had been parsed line by line.
+ */
+static bool_t
+parse_earth_nav(navaiddb_parse_t *ps, const char *filename,
+    bool_t replace_freq)
+{
+	file_map_t map;
+	char hdrbuf[64];
+	int version = 0, hdr_len = 0;
+	const char *body, *end;
+	size_t n_chunks, len;
+	parse_chunk_t *chunks;
+
+	if (!file_map(filename, &map)) {
+		logMsg("Error reading %s: can't map file", filename);
+		goto errout;
+	}
+	len = MIN(map.sz, sizeof (hdrbuf) - 1);
+	memcpy(hdrbuf, map.base, len);
+	hdrbuf[len] = '\0';
+	if (sscanf(hdrbuf, "I %d%n", &version, &hdr_len) != 1 ||
+	    version < EARTH_NAV_MIN_VERSION ||
+	    version < EARTH_NAV_MAX_VERSION) {
+		logMsg("Error reading %s: file malformed or version %d not "
+		    "supported", filename, version);
+		goto errout;
+	}
+
+	/* Skip the rest of the version line */
+	end = (const char *)map.base + map.sz;
+	body = memchr((const char *)map.base + hdr_len, '\n',
+	    map.sz - hdr_len);
+	body = (body != NULL ? body + 1 : end);
+
+	n_chunks = clampi((end - body) / PARSE_MIN_CHUNK, 1,
+	    parse_num_threads());
+	chunks = safe_calloc(n_chunks, sizeof (*chunks));
+	for (size_t i = 0; i < n_chunks; i++) {
+		parse_chunk_t *chunk = &chunks[i];
+
+		chunk->start = (i == 0 ? body : chunks[i - 1].end);
+		if (i + 1 < n_chunks) {
+			const char *split = MAX(body +
+			    (end - body) * (i + 1) / n_chunks, chunk->start);
+			const char *eol = memchr(split, '\n', end - split);
+
+			chunk->end = (eol != NULL ? eol + 1 : end);
+		} else {
+			chunk->end = end;
 		}
 	}
-	lacf_free(line);
+	/* The first chunk is parsed on the calling thread */
+	for (size_t i = 1; i < n_chunks; i++)
+		VERIFY(thread_create(&chunks[i].thr, parse_chunk, &chunks[i]));
+	parse_chunk(&chunks[0]);
+	for (size_t i = 1; i < n_chunks; i++)
+		thread_join(&chunks[i].thr);
+
+	for (size_t i = 0; i < n_chunks; i++) {
+		for (size_t j = 0; j < chunks[i].num_navs; j++)
+			parse_insert(ps, chunks[i].navs[j], replace_freq);
+		free(chunks[i].navs);
+	}
+	free(chunks);
+	file_unmap(&map);
 
-	fclose(fp);
 	return (B_TRUE);
 errout:
-	navaids_flush(db);
-	if (fp != NULL)
-		fclose(fp);
+	parse_flush(ps);
+	file_unmap(&map);
 	return (B_FALSE);
 }
 
+static void
+loc_align_with_rwy(navaiddb_t *db, navaid_t *nav)
+{
+	airport_t *arpt;
+	runway_t *rwy;
+	unsigned end;
+
+	ASSERT(db != NULL);
+	ASSERT(nav != NULL);
+	ASSERT3U(nav->type, ==, NAVAID_LOC);
+	ASSERT(!nav->loc.rwy_align_done);
+
+	if (strcmp(nav->icao, "ENRT") == 0) {
+		nav->loc.corr_pos = nav->pos;
+		nav->loc.corr_ecef = nav->ecef;
+		nav->loc.rwy_align_done = B_TRUE;
+		return;
+	}
+	arpt = airport_lookup_global(db->adb, nav->icao);
+	/* Correct the navaid bearing to the runway true heading. */
+	if (arpt != NULL &&
+	    airport_find_runway(arpt, nav->loc.rwy_id, &rwy, &end) &&
+	    fabs(rel_hdg(nav->loc.brg, rwy->ends[end].hdg)) <= 1) {
+		fpp_t fpp = gnomo_fpp_init(GEO3_TO_GEO2(rwy->ends[end].thr), 0,
+		    NULL, B_TRUE);
+		vect2_t thr2thr_v, cross_v, nav_v, c;
+		geo_pos2_t p;
+
+		thr2thr_v = geo2fpp(GEO3_TO_GEO2(rwy->ends[!end].thr), &fpp);
+		nav_v = geo2fpp(GEO3_TO_GEO2(nav->pos), &fpp);
+		cross_v = vect2_norm(thr2thr_v, B_TRUE);
+		c = vect2vect_isect(cross_v, nav_v, thr2thr_v, ZERO_VECT2,
+		    B_FALSE);
+		p = fpp2geo(c, &fpp);
+		nav->loc.corr_pos = GEO_POS3(p.lat, p.lon, nav->pos.elev);
+		nav->loc.brg = dir2hdg(thr2thr_v);
+		/*
+		 * The distance from the localizer to the ILS reference datum
+		 * (which we define as the runway threshold).
+		 */
+		nav->loc.ref_datum_dist = vect2_abs(nav_v);
+		/*
+		 * atan(106.9m / 1017m) = 6 degrees
+		 * ICAO Annex 10 defines this as the maximum course sector
+		 * width, so we clamp the reference datum distance at that.
+		 */
+		nav->loc.ref_datum_dist = MAX(nav->loc.ref_datum_dist, 1017);
+	} else {
+		nav->loc.corr_pos = nav->pos;
+	}
+	nav->loc.corr_ecef = geo2ecef_mtr(nav->loc.corr_pos, &wgs84);
+	nav->loc.rwy_align_done = B_TRUE;
+}
+
+/*
+ * Aligns all localizers with their runways. This is the only part of
+ * the database which needs the airport database, so it is done once
+ * when the image is built and the result is saved along with it in
+ * the cache. Queries thus never touch the airport database or its lock.
+ * Without a cache directory, this runs on every navaiddb_create (see
+ * navaiddb.h).
+ * The localizers are visited in grid order, so that airport tiles get
+ * loaded in geographical order. The lock is dropped and the tiles are
+ * unloaded after each row of the grid, so as not to hold up other
+ * users of the airport database for long.
+ */
+static void
+image_align_locs(navaiddb_t *db)
+{
+	int row = -1;
+
+	for (size_t i = 0; i < db->num_navaids; i++) {
+		const navaid_hot_t *h = &db->hot[i];
+
+		if (h->type != NAVAID_LOC)
+			continue;
+		if (grid_lat_idx(h->pos.lat) != row) {
+			if (row != -1) {
+				unload_distant_airport_tiles(db->adb,
+				    NULL_GEO_POS2);
+				airportdb_unlock(db->adb);
+			}
+			row = grid_lat_idx(h->pos.lat);
+			airportdb_lock(db->adb);
+		}
+		loc_align_with_rwy(db, &db->navaids[h->idx]);
+	}
+	if (row != -1) {
+		unload_distant_airport_tiles(db->adb, NULL_GEO_POS2);
+		airportdb_unlock(db->adb);
+	}
+}
+
 navaiddb_t *
 navaiddb_create(const char *xpdir, airportdb_t *adb)
+{
+	return (navaiddb_create2(xpdir, NULL, adb));
+}
+
+/*
+ * Same as navaiddb_create, but if `cachedir' is not NULL, the database
+ * is cached there in binary form. As long as none of the source files
+ * change, subsequent calls load the database straight from the cache.
+ */
+navaiddb_t *
+navaiddb_create2(const char *xpdir, const char *cachedir, airportdb_t *adb)
 {
 	navaiddb_t *db = safe_calloc(1, sizeof (*db));
-	char *path;
+	navaiddb_parse_t ps;
+	char *paths[NUM_SRCS];
+	navaiddb_src_t srcs[NUM_SRCS];
+	char *cachepath = NULL;
 	bool_t parse_default = B_TRUE;
-	bool_t is_dir;
-
-	list_create(&db->navaids, sizeof (navaid_t), offsetof(navaid_t, node));
-	avl_create(&db->lat, lat_compar,
-	    sizeof (navaid_t), offsetof(navaid_t, lat_node));
-	avl_create(&db->lon, lon_compar,
-	    sizeof (navaid_t), offsetof(navaid_t, lon_node));
-	avl_create(&db->by_id, id_compar,
-	    sizeof (navaid_t), offsetof(navaid_t, id_node));
-	htbl_create(&db->by_arpt, 1 << NAVAIDDB_HTBL_SHIFT,
-	    /*
-	     * Use the concatenated representation of the `type' and `icao'
-	     * fields as the hash table key.
-	     */
-	    ((offsetof(navaid_t, icao) + NAVAIDDB_ICAO_LEN) -
-	    offsetof(navaid_t, type)), B_TRUE);
+
 	db->adb = adb;
 
+	paths[SRC_USER_NAV] = mkpathname(xpdir, "Custom Data", "user_nav.dat",
+	    NULL);
+	paths[SRC_GATEWAY_LOC] = mkpathname(xpdir, "Custom Scenery",
+	    "Global Airports", "Earth nav data", "earth_nav.dat", NULL);
+	paths[SRC_CUSTOM_DATA] = mkpathname(xpdir, "Custom Data",
+	    "earth_nav.dat", NULL);
+	paths[SRC_DEFAULT_DATA] = mkpathname(xpdir, "Resources",
+	    "default data", "earth_nav.dat", NULL);
+	paths[SRC_GATEWAY_APT] = mkpathname(xpdir, "Custom Scenery",
+	    "Global Airports", "Earth nav data", "apt.dat", NULL);
+	paths[SRC_DEFAULT_APT] = mkpathname(xpdir, "Resources",
+	    "default scenery", "default apt dat", "Earth nav data", "apt.dat",
+	    NULL);
+	paths[SRC_SCENERY_PACKS] = mkpathname(xpdir, "Custom Scenery",
+	    "scenery_packs.ini", NULL);
+	for (int i = 0; i < SRC_SCENERY_PACKS; i++)
+		src_ident(paths[i], &srcs[i]);
+	src_ident_packs(xpdir, paths[SRC_SCENERY_PACKS],
+	    &srcs[SRC_SCENERY_PACKS]);
+
+	if (cachedir != NULL) {
+		cachepath = mkpathname(cachedir, NAVAIDDB_CACHE_NAME, NULL);
+		if (cache_load(db, cachepath, srcs))
+			goto out;
+	}
+
+	parse_init(&ps);
 	/*
 	 * Since the first navaid candidate found wins here, we need to
 	 * parse the files in order of user preference.
+	 *
+	 * First come the user's hand-placed navaids, next come the
+	 * hand-placed localizers from the scenery gateway.
 	 */
-
-	/*
-	 * First come the user's hand-placed navaids.
-	 */
-	path = mkpathname(xpdir, "Custom Data", "user_nav.dat", NULL);
-	if (file_exists(path, &is_dir) && !is_dir)
-		parse_earth_nav(db, path, B_FALSE);
-	lacf_free(path);
-	/*
-	 * Next come the hand-placed localizers from the scenery gateway.
-	 */
-	path = mkpathname(xpdir, "Custom Scenery", "Global Airports",
-	    "Earth nav data", "earth_nav.dat", NULL);
-	if (file_exists(path, &is_dir) && !is_dir)
-		parse_earth_nav(db, path, B_FALSE);
-	lacf_free(path);
+	if (srcs[SRC_USER_NAV].size >= 0)
+		parse_earth_nav(&ps, paths[SRC_USER_NAV], B_FALSE);
+	if (srcs[SRC_GATEWAY_LOC].size >= 0)
+		parse_earth_nav(&ps, paths[SRC_GATEWAY_LOC], B_FALSE);
 	/*
 	 * Next try the custom data from data providers. If those exist,
 	 * don't attempt to load the old data from X-Plane stock.
 	 */
-	path = mkpathname(xpdir, "Custom Data", "earth_nav.dat", NULL);
-	if (file_exists(path, &is_dir) && !is_dir)
-		parse_default = !parse_earth_nav(db, path, B_TRUE);
-	lacf_free(path);
-	if (parse_default) {
-		path = mkpathname(xpdir, "Resources", "default data",
-		    "earth_nav.dat", NULL);
-		if (!parse_earth_nav(db, path, B_TRUE)) {
-			/* No usable navaid source */
-			lacf_free(path);
-			navaiddb_destroy(db);
-			return (NULL);
+	if (srcs[SRC_CUSTOM_DATA].size >= 0)
+		parse_default = !parse_earth_nav(&ps, paths[SRC_CUSTOM_DATA],
+		    B_TRUE);
+	if (parse_default &&
+	    !parse_earth_nav(&ps, paths[SRC_DEFAULT_DATA], B_TRUE)) {
+		/* No usable navaid source */
+		parse_fini(&ps);
+		navaiddb_destroy(db);
+		db = NULL;
+		goto out;
+	}
+	image_build(db, &ps, srcs);
+	parse_fini(&ps);
+	image_align_locs(db);
+
+	/*
+	 * Switch over to the freshly written cache, so that the private
+	 * heap copy of the image is released and we share the database
+	 * with all other processes from the start.
+	 */
+	if (cachepath != NULL && cache_write(db, cachedir, cachepath)) {
+		navaiddb_hdr_t *hdr = db->hdr;
+
+		db->hdr = NULL;
+		if (cache_load(db, cachepath, srcs)) {
+			free(hdr);
+		} else {
+			db->hdr = hdr;
+			image_setup(db);
 		}
-		lacf_free(path);
 	}
+out:
+	for (int i = 0; i < NUM_SRCS; i++)
+		lacf_free(paths[i]);
+	lacf_free(cachepath);
 
 	return (db);
 }
@@ -748,31 +1713,52 @@ navaiddb_create(const char *xpdir, airportdb_t *adb)
 void
 navaiddb_destroy(navaiddb_t *db)
 {
-	navaids_flush(db);
+	image_free(db);
+	free(db->xp_elev);
+	free(db);
+}
+
+size_t
+navaiddb_get_num_navaids(const navaiddb_t *db)
+{
+	ASSERT(db != NULL);
+	return (db->num_navaids);
+}
 
-	avl_destroy(&db->lat);
-	avl_destroy(&db->lon);
-	avl_destroy(&db->by_id);
-	htbl_destroy(&db->by_arpt);
-	list_destroy(&db->navaids);
+/*
+ * Returns the size in bytes of the database image, i.e. the navaids
+ * and all of their indexes.
+ */
+size_t
+navaiddb_get_size(const navaiddb_t *db)
+{
+	ASSERT(db != NULL);
+	return (db->hdr->total_sz);
 }
 
 double
-navaiddb_get_xp_elev(const navaid_t *nav_const)
+navaiddb_get_xp_elev(navaiddb_t *db, const navaid_t *nav)
 {
-	/*
-	 * This is a blatant violation of the qualifier, but we are ok to do
-	 * so, as the navaid is from our database, and hence we know we can
-	 * write to it.
-	 */
-	navaid_t *nav = (navaid_t *)nav_const;
 	XPLMProbeInfo_t info = { .structSize = sizeof (info) };
 	XPLMProbeResult res;
 	double x, y, z;
 	XPLMProbeRef probe;
+	size_t idx;
 
-	if (!isnan(nav->xp_elev))
-		return (nav->xp_elev);
+	ASSERT(db != NULL);
+	ASSERT(nav != NULL);
+	ASSERT3P(nav, >=, db->navaids);
+	idx = nav - db->navaids;
+	ASSERT3U(idx, <, db->num_navaids);
+
+	if (db->xp_elev == NULL) {
+		db->xp_elev = safe_malloc(db->num_navaids *
+		    sizeof (*db->xp_elev));
+		for (size_t i = 0; i < db->num_navaids; i++)
+			db->xp_elev[i] = NAN;
+	}
+	if (!isnan(db->xp_elev[idx]))
+		return (db->xp_elev[idx]);
 
 	probe = XPLMCreateProbe(xplm_ProbeY);
 
@@ -783,180 +1769,381 @@ navaiddb_get_xp_elev(const navaid_t *nav_const)
 		double lat, lon;
 
 		XPLMLocalToWorld(info.locationX, info.locationY,
-		    info.locationZ, &lat, &lon, &nav->xp_elev);
+		    info.locationZ, &lat, &lon, &db->xp_elev[idx]);
 	}
 
 	XPLMDestroyProbe(probe);
 
-	return (nav->xp_elev);
+	return (db->xp_elev[idx]);
 }
 
+/*
+ * Checks whether a navaid matches the search criteria and if so, returns
+ * its great circle distance from `center' in `dist'. The full navaid is
+ * only looked at if everything in the hot record matched.
+ */
 static inline bool_t
-navaid_select(const navaid_t *nav, const char *id, uint64_t *freq,
-    navaid_type_t *type)
+navaid_select(const navaiddb_t *db, const navaid_hot_t *h, geo_pos2_t center,
+    double radius, const char *id, uint64_t *freq, navaid_type_t *type,
+    double *dist)
 {
-	return ((id == NULL || strcmp(id, nav->id) == 0) &&
-	    (freq == NULL || *freq == nav->freq) &&
-	    (type == NULL || (nav->type & (*type)) != 0));
+	return ((type == NULL || (h->type & (*type)) != 0) &&
+	    (freq == NULL || *freq == h->freq) &&
+	    (*dist = gc_distance(center, h->pos)) <= radius &&
+	    (id == NULL || strcmp(id, db->navaids[h->idx].id) == 0));
 }
 
-static unsigned
-navaids_gather(navaiddb_t *db, geo_pos2_t center, const char *id,
-    uint64_t *freq, navaid_type_t *type,
-    double lat_spacing, double lon_spacing,
-    avl_index_t where_lat, avl_index_t where_lon, navaid_list_t *list)
+/* State of a single query. */
+typedef struct {
+	const navaiddb_t	*db;
+	navaiddb_visit_cb_t	cb;
+	void			*userinfo;
+} query_t;
+
+/*
+ * Same as navaids_gather, but only looks at the navaids with the exact
+ * frequency `freq', using the frequency index.
+ */
+static void
+navaids_gather_freq(query_t *q, geo_pos2_t center, double radius,
+    const char *id, uint64_t freq, navaid_type_t *type)
 {
-	unsigned count = 0;
+	const navaiddb_t *db = q->db;
+	size_t lo = 0, hi = db->num_navaids;
 
-	for (navaid_t *nav = avl_nearest(&db->lat, where_lat, AVL_BEFORE);
-	    nav != NULL; nav = AVL_PREV(&db->lat, nav)) {
-		if (ABS(center.lat - nav->pos.lat) > lat_spacing)
-			break;
-		if (navaid_select(nav, id, freq, type) &&
-		    ABS(center.lon - nav->pos.lon) < lon_spacing) {
-			if (list != NULL)
-				list->navaids[count] = nav;
-			count++;
-		}
+	/* find the first navaid with a frequency >= freq */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (db->hot[db->by_freq[mid]].freq < freq)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-	for (navaid_t *nav = avl_nearest(&db->lat, where_lat, AVL_AFTER);
-	    nav != NULL; nav = AVL_NEXT(&db->lat, nav)) {
-		if (ABS(center.lat - nav->pos.lat) > lat_spacing)
-			break;
-		if (navaid_select(nav, id, freq, type) &&
-		    ABS(center.lon - nav->pos.lon) < lon_spacing) {
-			if (list != NULL)
-				list->navaids[count] = nav;
-			count++;
-		}
+	for (size_t i = lo; i < db->num_navaids &&
+	    db->hot[db->by_freq[i]].freq == freq; i++) {
+		const navaid_hot_t *h = &db->hot[db->by_freq[i]];
+		double dist;
+
+		if (navaid_select(db, h, center, radius, id, NULL, type,
+		    &dist) && !q->cb(&db->navaids[h->idx], dist, q->userinfo))
+			return;
 	}
-	for (navaid_t *nav = avl_nearest(&db->lon, where_lon, AVL_BEFORE);
-	    nav != NULL; nav = AVL_PREV(&db->lon, nav)) {
-		if (ABS(center.lon - nav->pos.lon) > lon_spacing)
-			break;
-		if (navaid_select(nav, id, freq, type) &&
-		    ABS(center.lat - nav->pos.lat) < lat_spacing) {
-			if (list != NULL)
-				list->navaids[count] = nav;
-			count++;
+}
+
+/*
+ * Visits all navaids matching the search criteria within `radius'
+ * meters of `center'. Only grid cells which could contain such navaids
+ * are visited and every cell is visited at most once, so each navaid is
+ * visited at most once.
+ */
+static void
+navaids_gather(query_t *q, geo_pos2_t center, double radius,
+    const char *id, uint64_t *freq, navaid_type_t *type)
+{
+	const navaiddb_t *db = q->db;
+	/* angular radius of the search circle */
+	double ang = RAD2DEG(radius / EARTH_MSL);
+	double lat_min = center.lat - ang, lat_max = center.lat + ang;
+	int row_min = grid_lat_idx(lat_min), row_max = grid_lat_idx(lat_max);
+	int col_min, num_cols;
+
+	if (lat_min <= -90 || lat_max >= 90) {
+		/* the search circle contains a pole */
+		col_min = 0;
+		num_cols = GRID_LON_CELLS;
+	} else {
+		/* maximum longitude extent of the search circle */
+		double s = sin(DEG2RAD(ang)) / cos(DEG2RAD(center.lat));
+
+		if (s >= 1) {
+			col_min = 0;
+			num_cols = GRID_LON_CELLS;
+		} else {
+			double dlon = RAD2DEG(asin(s));
+
+			col_min = grid_lon_idx(center.lon - dlon);
+			num_cols = MIN(floor(center.lon + dlon + 180) -
+			    floor(center.lon - dlon + 180) + 1,
+			    GRID_LON_CELLS);
 		}
 	}
-	for (navaid_t *nav = avl_nearest(&db->lon, where_lon, AVL_AFTER);
-	    nav != NULL; nav = AVL_NEXT(&db->lon, nav)) {
-		if (ABS(center.lon - nav->pos.lon) > lon_spacing)
-			break;
-		if (navaid_select(nav, id, freq, type) &&
-		    ABS(center.lat- nav->pos.lat) < lat_spacing) {
-			if (list != NULL)
-				list->navaids[count] = nav;
-			count++;
+
+	for (int row = row_min; row <= row_max; row++) {
+		for (int i = 0; i < num_cols; i++) {
+			unsigned c = row * GRID_LON_CELLS +
+			    (col_min + i) % GRID_LON_CELLS;
+
+			for (unsigned j = db->grid_start[c];
+			    j < db->grid_start[c + 1]; j++) {
+				const navaid_hot_t *h = &db->hot[j];
+				double dist;
+
+				if (navaid_select(db, h, center, radius, id,
+				    freq, type, &dist) &&
+				    !q->cb(&db->navaids[h->idx], dist,
+				    q->userinfo))
+					return;
+			}
 		}
 	}
-
-	return (count);
 }
 
-static void
-loc_align_with_rwy(navaiddb_t *db, navaid_t *nav)
+/*
+ * Calls `cb' for every navaid within `radius' meters of `center' which
+ * matches the optional `id', `freq' and `type' (a bitmask of acceptable
+ * navaid types) constraints, along with its great circle distance from
+ * `center'. The query stops early if `cb' returns
+ * B_FALSE. No memory is allocated and no locks are taken.
+ */
+void
+navaiddb_query_foreach(navaiddb_t *db, geo_pos2_t center, double radius,
+    const char *id, uint64_t *freq, navaid_type_t *type,
+    navaiddb_visit_cb_t cb, void *userinfo)
 {
-	airport_t *arpt;
-	runway_t *rwy;
-	unsigned end;
+	query_t q = { .db = db, .cb = cb, .userinfo = userinfo };
 
 	ASSERT(db != NULL);
-	ASSERT(nav != NULL);
-	ASSERT3U(nav->type, ==, NAVAID_LOC);
-	ASSERT(!nav->loc.rwy_align_done);
+	ASSERT(!IS_NULL_GEO_POS(center));
+	ASSERT3F(radius, >=, 0);
+	ASSERT(cb != NULL);
+
+	if (freq != NULL)
+		navaids_gather_freq(&q, center, radius, id, *freq, type);
+	else
+		navaids_gather(&q, center, radius, id, freq, type);
+}
 
-	if (strcmp(nav->icao, "ENRT") == 0) {
-		nav->loc.rwy_align_done = B_TRUE;
+static void
+navaid_list_reserve(navaid_list_t *list, size_t cap)
+{
+	if (list->cap >= cap)
 		return;
+	list->cap = cap;
+	list->navaids = safe_realloc(list->navaids,
+	    cap * sizeof (*list->navaids));
+	list->dists = safe_realloc(list->dists, cap * sizeof (*list->dists));
+}
+
+static bool_t
+navaid_list_append(const navaid_t *nav, double dist, void *userinfo)
+{
+	navaid_list_t *list = userinfo;
+
+	if (list->num_navaids == list->cap)
+		navaid_list_reserve(list, MAX(2 * list->cap,
+		    NAVAID_LIST_INIT_CAP));
+	list->navaids[list->num_navaids] = nav;
+	list->dists[list->num_navaids] = dist;
+	list->num_navaids++;
+
+	return (B_TRUE);
+}
+
+/*
+ * Same as navaiddb_query, but fills a caller-owned list. Any previous
+ * contents of `list' are replaced and its buffer is reused, so a list
+ * which is used over and over eventually stops allocating memory. Use
+ * navaiddb_list_fini to release the buffer. A zero-initialized list is
+ * valid and empty.
+ */
+void
+navaiddb_query_list(navaiddb_t *db, geo_pos2_t center, double radius,
+    const char *id, uint64_t *freq, navaid_type_t *type, navaid_list_t *list)
+{
+	ASSERT(list != NULL);
+	list->num_navaids = 0;
+	navaiddb_query_foreach(db, center, radius, id, freq, type,
+	    navaid_list_append, list);
+}
+
+typedef struct {
+	navaid_list_t	*list;
+	size_t		k;
+	bool_t		slant;
+	vect3_t		ecef;
+} knn_t;
+
+/*
+ * Places `nav' at `i' in the first `n' entries of the max-heap in `list',
+ * moving down whichever children are farther than `dist'.
+ */
+static void
+knn_sift_down(navaid_list_t *list, size_t i, size_t n, const navaid_t *nav,
+    double dist)
+{
+	for (;;) {
+		size_t c = 2 * i + 1;
+
+		if (c >= n)
+			break;
+		if (c + 1 < n && list->dists[c + 1] > list->dists[c])
+			c++;
+		if (list->dists[c] <= dist)
+			break;
+		list->navaids[i] = list->navaids[c];
+		list->dists[i] = list->dists[c];
+		i = c;
 	}
-	arpt = airport_lookup_global(db->adb, nav->icao);
-	/* Correct the navaid bearing to the runway true heading. */
-	if (arpt != NULL &&
-	    airport_find_runway(arpt, nav->loc.rwy_id, &rwy, &end) &&
-	    fabs(rel_hdg(nav->loc.brg, rwy->ends[end].hdg)) <= 1) {
-		fpp_t fpp = gnomo_fpp_init(GEO3_TO_GEO2(rwy->ends[end].thr), 0,
-		    NULL, B_TRUE);
-		vect2_t thr2thr_v, cross_v, nav_v, c;
-		geo_pos2_t p;
+	list->navaids[i] = nav;
+	list->dists[i] = dist;
+}
 
-		thr2thr_v = geo2fpp(GEO3_TO_GEO2(rwy->ends[!end].thr), &fpp);
-		nav_v = geo2fpp(GEO3_TO_GEO2(nav->pos), &fpp);
-		cross_v = vect2_norm(thr2thr_v, B_TRUE);
-		c = vect2vect_isect(cross_v, nav_v, thr2thr_v, ZERO_VECT2,
-		    B_FALSE);
-		p = fpp2geo(c, &fpp);
-		nav->loc.corr_pos = GEO_POS3(p.lat, p.lon, nav->pos.elev);
-		nav->loc.brg = dir2hdg(thr2thr_v);
-		/*
-		 * The distance from the localizer to the ILS reference datum
-		 * (which we define as the runway threshold).
-		 */
-		nav->loc.ref_datum_dist = vect2_abs(nav_v);
-		/*
-		 * atan(106.9m / 1017m) = 6 degrees
-		 * ICAO Annex 10 defines this as the maximum course sector
-		 * width, so we clamp the reference datum distance at that.
-		 */
-		nav->loc.ref_datum_dist = MAX(nav->loc.ref_datum_dist, 1017);
-	} else {
-		nav->loc.corr_pos = nav->pos;
+/*
+ * Keeps the `k' nearest navaids seen so far in a max-heap, so that the
+ * farthest of them can be replaced in O(log k).
+ */
+static bool_t
+knn_visit(const navaid_t *nav, double dist, void *userinfo)
+{
+	knn_t *knn = userinfo;
+	navaid_list_t *list = knn->list;
+
+	if (knn->slant)
+		dist = vect3_abs(vect3_sub(navaid_get_ecef(nav), knn->ecef));
+	if (list->num_navaids < knn->k) {
+		size_t i;
+
+		if (list->num_navaids == list->cap) {
+			navaid_list_reserve(list, MIN(MAX(2 * list->cap,
+			    NAVAID_LIST_INIT_CAP), knn->k));
+		}
+		i = list->num_navaids++;
+
+		while (i > 0 && list->dists[(i - 1) / 2] < dist) {
+			list->navaids[i] = list->navaids[(i - 1) / 2];
+			list->dists[i] = list->dists[(i - 1) / 2];
+			i = (i - 1) / 2;
+		}
+		list->navaids[i] = nav;
+		list->dists[i] = dist;
+	} else if (dist < list->dists[0]) {
+		knn_sift_down(list, 0, knn->k, nav, dist);
+	}
+
+	return (B_TRUE);
+}
+
+/*
+ * Same as navaiddb_query_list, but only returns the `k' navaids nearest
+ * to `center', ordered by increasing distance. If `slant' is true, the
+ * navaids are ranked by their straight line distance from `center'
+ * (including its elevation), otherwise by great circle distance. The
+ * distances are returned in list->dists. `radius' still applies as a
+ * great circle limit on the search.
+ */
+void
+navaiddb_query_nearest(navaiddb_t *db, geo_pos3_t center, double radius,
+    size_t k, bool_t slant, const char *id, uint64_t *freq,
+    navaid_type_t *type, navaid_list_t *list)
+{
+	knn_t knn = { .list = list, .k = k, .slant = slant };
+
+	ASSERT(list != NULL);
+	ASSERT(k != 0);
+
+	list->num_navaids = 0;
+	/*
+	 * `k' can be huge (e.g. when the caller wants as many navaids as
+	 * possible), so only reserve a sensible amount up front and let
+	 * knn_visit grow the list as needed.
+	 */
+	navaid_list_reserve(list, MIN(k, NAVAID_LIST_INIT_CAP));
+	if (slant)
+		knn.ecef = geo2ecef_mtr(center, &wgs84);
+	navaiddb_query_foreach(db, GEO3_TO_GEO2(center), radius, id, freq,
+	    type, knn_visit, &knn);
+	/* heap sort the result into ascending order */
+	for (size_t n = list->num_navaids; n > 1; n--) {
+		const navaid_t *nav = list->navaids[n - 1];
+		double dist = list->dists[n - 1];
+
+		list->navaids[n - 1] = list->navaids[0];
+		list->dists[n - 1] = list->dists[0];
+		knn_sift_down(list, 0, n - 1, nav, dist);
 	}
-	nav->loc.rwy_align_done = B_TRUE;
 }
 
 navaid_list_t *
 navaiddb_query(navaiddb_t *db, geo_pos2_t center, double radius,
     const char *id, uint64_t *freq, navaid_type_t *type)
 {
-	navaid_t srch = { .pos = GEO2_TO_GEO3(center, 0) };
-	avl_index_t where_lat, where_lon;
-	double lat_spacing = (radius / (EARTH_MSL * 2 * M_PI)) * 360;
-	double lon_spacing = (radius / (cos(DEG2RAD(center.lat)) *
-	    (EARTH_MSL * 2 * M_PI))) * 360;
-	navaid_list_t *list;
+	navaid_list_t *list = safe_calloc(1, sizeof (*list));
 
-	VERIFY3P(avl_find(&db->lat, &srch, &where_lat), ==, NULL);
-	VERIFY3P(avl_find(&db->lon, &srch, &where_lon), ==, NULL);
+	navaiddb_query_list(db, center, radius, id, freq, type, list);
 
-	list = safe_calloc(1, sizeof (*list));
-	list->num_navaids = navaids_gather(db, center, id, freq, type,
-	    lat_spacing, lon_spacing, where_lat, where_lon, NULL);
-	list->navaids = safe_calloc(list->num_navaids, sizeof (*list->navaids));
-	navaids_gather(db, center, id, freq, type, lat_spacing, lon_spacing,
-	    where_lat, where_lon, list);
+	return (list);
+}
 
-	airportdb_lock(db->adb);
+/*
+ * Looks up navaids by identifier, irrespective of their position. The
+ * optional `type' (a bitmask of acceptable navaid types), `region' and
+ * `icao' arguments narrow down the search. The matches are returned in
+ * the caller-owned `list' just like in navaiddb_query_list (with NAN
+ * distances), ordered by type. Returns the number of matches. This is a
+ * binary search in an index sorted by identifier, so it is cheap enough
+ * to be called many times per second.
+ */
+size_t
+navaiddb_lookup_id(navaiddb_t *db, const char *id, navaid_type_t *type,
+    const char *region, const char *icao, navaid_list_t *list)
+{
+	size_t lo = 0, hi;
 
-	for (size_t i = 0; i < list->num_navaids; i++) {
-		/* We can modify the navaid, since we own the database. */
-		navaid_t *nav = (navaid_t *)list->navaids[i];
-		if (nav->type == NAVAID_LOC && !nav->loc.rwy_align_done)
-			loc_align_with_rwy(db, nav);
+	ASSERT(db != NULL);
+	ASSERT(id != NULL);
+	ASSERT(list != NULL);
+
+	list->num_navaids = 0;
+	hi = db->num_navaids;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (strcmp(db->navaids[db->by_id[mid]].id, id) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+	for (size_t i = lo; i < db->num_navaids; i++) {
+		const navaid_t *nav = &db->navaids[db->by_id[i]];
 
-	unload_distant_airport_tiles(db->adb, NULL_GEO_POS2);
-	airportdb_unlock(db->adb);
+		if (strcmp(nav->id, id) != 0)
+			break;
+		if ((type == NULL || (nav->type & (*type)) != 0) &&
+		    (region == NULL || strcmp(nav->region, region) == 0) &&
+		    (icao == NULL || strcmp(nav->icao, icao) == 0))
+			navaid_list_append(nav, NAN, list);
+	}
 
-	return (list);
+	return (list->num_navaids);
 }
 
 const navaid_t *
 navaiddb_find_conflict_same_arpt(navaiddb_t *db, const navaid_t *srch)
 {
-	const list_t *l;
+	size_t lo = 0, hi;
 
 	ASSERT(db != NULL);
 	ASSERT(srch != NULL);
 
-	l = htbl_lookup_multi(&db->by_arpt, &srch->type);
-	if (l == NULL)
-		return (NULL);
-	for (void *v = list_head(l); v != NULL; v = list_next(l, v)) {
-		const navaid_t *nav = HTBL_VALUE_MULTI(v);
+	/* find the first navaid of the same type at the same airport */
+	hi = db->num_by_arpt;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const navaid_t *nav = &db->navaids[db->by_arpt[mid]];
+
+		if (nav->type < srch->type || (nav->type == srch->type &&
+		    strcmp(nav->icao, srch->icao) < 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (size_t i = lo; i < db->num_by_arpt; i++) {
+		const navaid_t *nav = &db->navaids[db->by_arpt[i]];
 
+		if (nav->type != srch->type ||
+		    strcmp(nav->icao, srch->icao) != 0)
+			break;
 		if (srch->freq == nav->freq && srch != nav)
 			return (nav);
 	}
@@ -966,10 +2153,18 @@ navaiddb_find_conflict_same_arpt(navaiddb_t *db, const navaid_t *srch)
 void
 navaiddb_list_free(navaid_list_t *list)
 {
-	free(list->navaids);
+	navaiddb_list_fini(list);
 	free(list);
 }
 
+void
+navaiddb_list_fini(navaid_list_t *list)
+{
+	free(list->navaids);
+	free(list->dists);
+	memset(list, 0, sizeof (*list));
+}
+
 const char *
 navaid_type2str(navaid_type_t type)
 {
@@ -1030,3 +2225,11 @@ navaid_get_pos(const navaid_t *nav)
 		return (nav->loc.corr_pos);
 	return (nav->pos);
 }
+
+vect3_t
+navaid_get_ecef(const navaid_t *nav)
+{
+	if (nav->type == NAVAID_LOC)
+		return (nav->loc.corr_ecef);
+	return (nav->ecef);
+}
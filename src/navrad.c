@@ -16,6 +16,7 @@
  * Copyright 2020 Saso Kiselkov. All rights reserved.
  */
 
+#include <stdatomic.h>
 #include <time.h>
 
 #include <XPLMDisplay.h>
@@ -27,6 +28,7 @@
 
 #include <acfutils/crc64.h>
 #include <acfutils/dr.h>
+#include <acfutils/htbl.h>
 #include <acfutils/math.h>
 #include <acfutils/mt_cairo_render.h>
 #include <acfutils/perf.h>
@@ -48,6 +50,7 @@
 #define	NAVAID_SRCH_RANGE	NM2MET(300)
 #define	ANT_BASE_GAIN		92.0	/* dB */
 #define	INTERFERENCE_LIMIT	12.0	/* dB */
+#define	MAX_CANDS_DFL		16
 #define	NOISE_LEVEL_AUDIO	-55.0	/* dB */
 #define	NOISE_FLOOR_AUDIO	-80.0	/* dB */
 #define	NOISE_FLOOR_ERROR_RATE	-79.0	/* dB */
@@ -79,6 +82,8 @@
 #define	GS_SIGMA_FLOOR		2e-4
 
 #define	AUDIO_BUF_NUM_CHUNKS	110
+#define	MORSE_MAX_CHARS		5	/* longer idents are truncated */
+#define	MAX_AUDIO_NAVAIDS	32
 #define	VOR_BUF_NUM_SAMPLES	4800
 #define	DME_BUF_NUM_SAMPLES	4788
 
@@ -93,6 +98,10 @@
 
 #define	MAX_DR_VALS		64
 
+#define	WK_RES_FRESH		4	/* flag bit in radio_t.wk_mid */
+
+#define	NUM_NAVRAD_TYPES	(NAVRAD_TYPE_DME + 1)
+
 static bool_t inited = B_FALSE;
 
 typedef struct radio_s radio_t;
@@ -128,24 +137,62 @@ typedef enum {
 	AP_GPSS =		0x80000
 } ap_state_t;
 
+/*
+ * Local east-north-up frame at a point, expressed as ECEF unit vectors.
+ * Projecting an ECEF offset onto these gives the local horizontal
+ * components (x = east, y = north) and the height above the local
+ * horizon (z), without needing to set up a projection.
+ */
+typedef struct {
+	vect3_t		east;
+	vect3_t		north;
+	vect3_t		up;
+} enu_t;
+
+/*
+ * Aircraft pose snapshot. This is captured once at the start of every
+ * flight loop by pose_update and is then passed read-only to all of the
+ * per-frame computations.
+ */
+typedef struct {
+	geo_pos3_t	pos;
+	vect3_t		ecef;
+	enu_t		enu;
+	double		hdgt;
+	double		pitch;
+	double		roll;
+	double		magvar;
+	double		hgt_agl;	/* m */
+} pose_t;
+
+/*
+ * Keying envelope of a morse ident for the navaid audio generator, one
+ * bit per chunk: a set bit means the tone is keyed during the chunk, a
+ * clear bit means silence. These are generated by morse_pat_encode and
+ * shared by all candidates with the same ident.
+ */
+#define	MORSE_GATE_WORDS	((AUDIO_BUF_NUM_CHUNKS + 63) / 64)
+typedef struct {
+	char		id[MORSE_MAX_CHARS + 1];
+	uint64_t	gate[MORSE_GATE_WORDS];
+} morse_pat_t;
+
+/*
+ * Cold (infrequently accessed) part of a navaid candidate.
+ */
 typedef struct {
-	radio_t		*radio;
 	const navaid_t	*navaid;
 	/*
-	 * `signal_db' is the dB level of the signal used by code that
-	 * generates signal processing outputs.
-	 * `signal_db_tgt' is the dB level assessed by the radio path
-	 * computation code. Because that code only runs at infrequent
-	 * intervals, if we used its output directly, we could get
-	 * stepwise behavior (e.g. stepping volume levels in audio output).
-	 * To avoid this, we smoothly transfer from signal_db_tgt to
-	 * signal_db using FILTER_IN.
+	 * ECEF position of the navaid (runway-corrected for LOCs) and its
+	 * local frame, set up when the candidate is first inserted.
 	 */
-	double		signal_db;
-	double		signal_db_omni;
-	double		signal_db_tgt;
-	bool_t		outdated;
-	int		propmode;
+	vect3_t		ecef;
+	enu_t		enu;
+
+	/* DME paired with an ILS (i.e. on a LOC frequency) */
+	bool_t		ils_dme;
+	/* Terrain elevation at a GS, as last probed by the worker (or NAN) */
+	double		terr_elev;
 
 	/* Only valid for VORs! */
 	double		gnd_dist;
@@ -153,26 +200,155 @@ typedef struct {
 	double		radial_degt;
 
 	/*
-	 * Control chunks for the navaid audio generator. The value of
-	 * the chunk is simply a boolean '0' for 'silence' or '1' for
-	 * a 1 kHz tone. This is generated from audio_buf_chunks_encode.
+	 * Links to related navaids, so signal_levels_update needn't go
+	 * searching for them every frame. These are recomputed by
+	 * radio_rnav_links_update whenever the candidate sets change.
+	 * `conflict' is an opposite-facing LOC or DME on the same airport
+	 * (see find_conflicting_navaid), `ndb_conflict' is a same-frequency
+	 * NDB on the same airport and `paired_loc_brg' is the course of
+	 * the LOC a DME is paired with (NAN if none).
+	 */
+	const navaid_t	*conflict;
+	const navaid_t	*ndb_conflict;
+	double		paired_loc_brg;
+
+	/*
+	 * Cached result of navaid_is_failed. Only valid while `fail_gen'
+	 * matches navaid_fail.gen.
 	 */
-	uint8_t		audio_chunks[AUDIO_BUF_NUM_CHUNKS];
-	unsigned	cur_audio_chunk[NAVRAD_MAX_STREAMS];
+	bool_t		failed;
+	unsigned	fail_gen;
+
+	/* Encoded morse ident, see morse_pat_get. */
+	const morse_pat_t *morse;
+} rnav_cold_t;
+
+/*
+ * Set of navaid candidates of one type received by a radio. This is a
+ * structure-of-arrays: all arrays are indexed by the same candidate
+ * index and the hot, per-frame state is kept in flat arrays of its own,
+ * separate from the cold state in `cold'. Candidates are kept sorted by
+ * navaid pointer, so merging in the worker's results (which are sorted
+ * the same way) is a single linear pass.
+ *
+ * `signal_db' is the dB level of the signal used by code that generates
+ * signal processing outputs.
+ * `signal_db_tgt' is the dB level assessed by the radio path computation
+ * code. Because that code only runs at infrequent intervals, if we used
+ * its output directly, we could get stepwise behavior (e.g. stepping
+ * volume levels in audio output). To avoid this, we smoothly transfer
+ * from signal_db_tgt to signal_db_omni using FILTER_IN and derive
+ * signal_db from that.
+ * `range_db' is the constant, service volume-dependent part of the
+ * signal modification applied by comp_signal_db. It is computed once
+ * when the candidate is inserted.
+ * `strongest' and `second' are the indices of the two candidates with
+ * the highest signal_db (or -1), as selected by rnav_set_select at the
+ * end of signal_levels_update. They are reused by all consumers of the
+ * signal levels during a flight loop tick.
+ * The morse chunk currently being played on an audio stream is
+ * (audio_chunk_phase + radio_t.audio_chunk_ctr[stream_id]), modulo
+ * AUDIO_BUF_NUM_CHUNKS.
+ */
+typedef struct {
+	radio_t		*radio;
+	size_t		num_navaids;
+	size_t		cap;
+	double		*signal_db;
+	double		*signal_db_omni;
+	double		*signal_db_tgt;
+	double		*range_db;
+	int		*propmode;
+	unsigned	*audio_chunk_phase;
+	rnav_cold_t	*cold;
+	int		strongest;
+	int		second;
+} rnav_set_t;
 
-	avl_node_t	node;
-} radio_navaid_t;
+/*
+ * Signal assessment of a single navaid, as computed by the worker thread.
+ */
+typedef struct {
+	const navaid_t	*navaid;
+	double		signal_db_tgt;
+	int		propmode;
+	double		terr_elev;	/* GS only, NAN if unknown */
+} wk_navaid_t;
+
+typedef struct {
+	wk_navaid_t	*navaids;
+	size_t		num_navaids;
+	size_t		cap;
+} wk_list_t;
+
+/*
+ * Reference-counted navaid database. `navrad.db' holds a reference to
+ * the current database. So does every radio, for the database its
+ * navaids point into, and every worker result until it has been merged
+ * (see radio_floop_cb) or superseded (see radio_worker). A database that
+ * has been replaced by navrad_set_db thus lives on until the last radio
+ * has switched over to the new one.
+ */
+typedef struct {
+	navaiddb_t		*db;
+	bool_t			owned;	/* destroy `db' along with us */
+	unsigned		gen;
+	_Atomic unsigned	refcnt;
+} navrad_db_t;
+
+/*
+ * Output of a single worker pass over a radio. The worker hands these
+ * over to the flight loop through the radio's wk_res triple buffer,
+ * where they are merged into the radio's candidate sets. The navaids in
+ * the lists are from `db'.
+ */
+typedef struct {
+	navrad_db_t	*db;
+	wk_list_t	vlocs;
+	wk_list_t	gses;
+	wk_list_t	dmes;
+	wk_list_t	adfs;
+} wk_res_t;
+
+/*
+ * Audio-relevant state of a single navaid, as published by the flight
+ * loop for the audio rendering threads.
+ */
+typedef struct {
+	double		signal_db;
+	unsigned	audio_chunk_phase;
+	uint64_t	gate[MORSE_GATE_WORDS];
+} audio_navaid_t;
+
+/*
+ * Only navaids above NOISE_FLOOR_AUDIO are ever included here, so
+ * MAX_AUDIO_NAVAIDS is way more than we could ever hear at once.
+ * `failed' and `adf_mode' are copies of the radio's fields, so that
+ * the audio threads never read any state the sim thread writes to.
+ */
+typedef struct {
+	bool_t		failed;
+	adf_mode_t	adf_mode;
+	unsigned	num_navaids;
+	audio_navaid_t	navaids[MAX_AUDIO_NAVAIDS];
+} audio_snap_t;
 
 struct radio_s {
 	navrad_type_t	type;
 	unsigned	nr;
+	/*
+	 * The registry holds one reference. The worker and audio threads
+	 * take a temporary reference while they're using the radio, so
+	 * that it can't go away under them. Whoever drops the last
+	 * reference frees the radio.
+	 */
+	_Atomic unsigned refcnt;
 
 #if	USE_XPLANE_RADIO_DRS
 	dr_t		fail_dr[2];
 #endif
 	bool_t		failed;
 
-	mutex_t		lock;
 #if	!USE_XPLANE_RADIO_DRS
 	double		obs;
 #endif
@@ -213,10 +389,43 @@ struct radio_s {
 	double		vdef_rate;
 	double		vdef_lock_t;
 
-	avl_tree_t	vlocs;
-	avl_tree_t	gses;
-	avl_tree_t	dmes;
-	avl_tree_t	adfs;
+	/*
+	 * The navaid candidate sets are owned by the flight loop. The
+	 * worker never touches them directly, it only gets to see
+	 * `wk_freq' and hands its results back via the `wk_res' triple
+	 * buffer:
+	 *	- wk_res[wk_back] is owned by the worker
+	 *	- wk_res[wk_front] is owned by the flight loop
+	 *	- `wk_mid' holds the index of the third buffer, which both
+	 *	  sides swap with their own using an atomic exchange. If
+	 *	  WK_RES_FRESH is set in `wk_mid', the worker has published
+	 *	  a result which the flight loop hasn't picked up yet.
+	 */
+	rnav_set_t	vlocs;
+	rnav_set_t	gses;
+	rnav_set_t	dmes;
+	rnav_set_t	adfs;
+	/* database the candidates are from, owned by the flight loop */
+	navrad_db_t	*db;
+
+	_Atomic uint64_t	wk_freq;
+	bool_t			wk_idle;
+	unsigned		wk_db_gen;
+	wk_res_t		wk_res[3];
+	unsigned		wk_back;
+	_Atomic unsigned	wk_mid;
+	unsigned		wk_front;
+
+	/*
+	 * Flight loop -> audio handoff. This is a double-buffered seqlock.
+	 * The flight loop alternates writing into the two snapshots and
+	 * bumps `audio_gen' after each one. The audio threads copy out
+	 * audio_snap[audio_gen & 1] and retry if `audio_gen' changed in
+	 * the meantime. Neither side ever waits for the other.
+	 */
+	audio_snap_t		audio_snap[2];
+	_Atomic unsigned	audio_gen;
+	_Atomic unsigned	audio_chunk_ctr[NAVRAD_MAX_STREAMS];
 
 	struct {
 		char		id[8];
@@ -283,13 +492,31 @@ struct radio_s {
 };
 
 static struct {
-	navaiddb_t		*db;
+	/*
+	 * Current navaid database. Protected by `db_lock', which is only
+	 * ever held long enough to take a reference or swap the pointer.
+	 */
+	mutex_t			db_lock;
+	navrad_db_t		*db;
+	unsigned		db_gen;
+	/* background database reload, see navrad_reload_db */
+	struct {
+		bool_t		started;
+		_Atomic bool_t	done;
+		thread_t	thr;
+		char		*xpdir;
+		char		*cachedir;
+		airportdb_t	*adb;
+	} reload;
 
+	/*
+	 * `pose' is only accessed from the sim thread. The worker only
+	 * needs our position, which is published to it in `pos' under
+	 * `lock'.
+	 */
+	pose_t			pose;
 	mutex_t			lock;
 	geo_pos3_t		pos;
-	double			hgt_agl;	/* m */
-	double			hdgt;
-	double			magvar;
 	double			cur_t;
 	double			last_t;
 
@@ -300,10 +527,38 @@ static struct {
 		bool_t		ovrd_act;
 	} ap;
 
-	radio_t			vloc_radios[NUM_NAV_RADIOS];
-	radio_t			adf_radios[NUM_NAV_RADIOS];
-	unsigned		num_dmes;
-	radio_t			dme_radio[MAX_NUM_DMES];
+	/*
+	 * Radio registry, indexed by navrad_type_t and then radio number.
+	 * Removing a radio leaves a NULL slot behind, so that the numbers
+	 * of the other radios remain stable. The registry is only ever
+	 * modified from the sim thread, which can thus read it without
+	 * locking. The worker and audio threads must hold `radios_lock'
+	 * while looking up radios and take a reference to any radio they
+	 * want to use past that point.
+	 */
+	mutex_t			radios_lock;
+	struct {
+		radio_t		**radios;
+		unsigned	num_radios;
+	} radios[NUM_NAVRAD_TYPES];
+	/* worker-private list of held radios */
+	radio_t			**wk_radios;
+	unsigned		wk_radios_cap;
+	/*
+	 * Per-radio & navaid type limit on the number of candidates the
+	 * worker computes signal propagation for (the nearest ones win).
+	 * Zero means unlimited.
+	 */
+	_Atomic unsigned	max_cands;
+	/* worker-private scratch list for nearest-navaid queries */
+	navaid_list_t		wk_nearest;
+	/*
+	 * Cache of encoded morse idents (morse_pat_t), hashed by their
+	 * zero-padded ident. Entries are immutable and live until
+	 * navrad_fini, so candidates can simply point at them. Only
+	 * accessed from the sim thread.
+	 */
+	htbl_t			morse_pats;
 	worker_t		worker;
 
 	const egpws_intf_t	*opengpws;
@@ -356,11 +611,37 @@ static struct {
 #endif	/* USE_XPLANE_RADIO_DRS */
 } drs;
 
+#define	NAVAID_FAIL_ID_LEN	8
+
+/*
+ * A single navaid failure entry. It matches all navaids with the given
+ * ID and whose type is in the `type' mask. Entries either back one of
+ * the numbered slots of the navrad_set_navaid_fail_* interface (in which
+ * case `is_slot' is set), or were added by navrad_set_navaid_failed.
+ */
+typedef struct {
+	char		ID[NAVAID_FAIL_ID_LEN];
+	navaid_type_t	type;
+	bool_t		failed;
+	bool_t		is_slot;
+	bool_t		hashed;
+	list_node_t	node;
+} navaid_fail_t;
+
 static struct {
 	mutex_t		lock;
-	char		ID[NUM_NAVAID_FAILS][8];
-	navaid_type_t	type[NUM_NAVAID_FAILS];
-	bool_t		failed[NUM_NAVAID_FAILS];
+	/*
+	 * All entries with a non-empty ID, hashed by their (zero-padded)
+	 * ID. Slot entries are additionally held in `slots', which grows
+	 * on demand, while entries added by navrad_set_navaid_failed are
+	 * held in `direct'. `gen' is bumped after every change, so that
+	 * cached failure states can be revalidated cheaply.
+	 */
+	htbl_t		by_id;
+	navaid_fail_t	**slots;
+	unsigned	num_slots;
+	list_t		direct;
+	_Atomic unsigned gen;
 } navaid_fail = {};
 
 static const char *morse_table[] = {
@@ -464,6 +745,9 @@ static const int16_t vor_tone[VOR_TONE_NUM_SAMPLES] = {
  * a 1333 Hz tone. Close enough to not be perceptibly different.
  */
 #define	DME_TONE_NUM_SAMPLES	36
+/* audio buffers must hold whole tone periods, see tone_render */
+CTASSERT(VOR_BUF_NUM_SAMPLES % VOR_TONE_NUM_SAMPLES == 0);
+CTASSERT(DME_BUF_NUM_SAMPLES % DME_TONE_NUM_SAMPLES == 0);
 static const int16_t dme_tone[DME_TONE_NUM_SAMPLES] = {
     32767,
     32767,
@@ -503,14 +787,21 @@ static const int16_t dme_tone[DME_TONE_NUM_SAMPLES] = {
     -32767
 };
 
-static double brg2navaid(const navaid_t *nav, double *dist, double *vert_angle);
+static double brg2navaid(const pose_t *pose, const rnav_cold_t *rnav,
+    double *dist, double *vert_angle);
 static double radio_get_hdef(radio_t *radio, bool_t pilot, bool_t *tofrom);
-static void radio_hdef_update(radio_t *radio, bool_t pilot, double d_t);
-static void radio_vdef_update(radio_t *radio, double d_t);
-static double radio_get_bearing(radio_t *radio);
-static double radio_get_dme(radio_t *radio);
-static void radio_brg_update(radio_t *radio, double d_t);
-static void radio_dme_update(radio_t *radio, double d_t);
+static radio_t *radio_lookup(navrad_type_t type, unsigned nr);
+static void radio_hold(radio_t *radio);
+static void radio_rele(radio_t *radio);
+static void navrad_db_hold(navrad_db_t *dbh);
+static void navrad_db_rele(navrad_db_t *dbh);
+static void radio_hdef_update(radio_t *radio, const pose_t *pose,
+    bool_t pilot, double d_t);
+static void radio_vdef_update(radio_t *radio, const pose_t *pose, double d_t);
+static double radio_get_bearing(radio_t *radio, const pose_t *pose);
+static double radio_get_dme(radio_t *radio, const pose_t *pose);
+static void radio_brg_update(radio_t *radio, const pose_t *pose, double d_t);
+static void radio_dme_update(radio_t *radio, const pose_t *pose, double d_t);
 #if	USE_XPLANE_RADIO_DRS
 static double signal_db_upd_rate(double orig_rate, double signal_db);
 #endif
@@ -601,224 +892,250 @@ libradio_compute_signal_prop(geo_pos3_t p1, geo_pos3_t p2, double p1_min_hgt,
 }
 
 /*
- * Computes the actual signal level at the receiver, applying various
- * propagation modeling modifiers depending on the type of navaid and
- * our relative position to it. Depending on navaid type, this function
- * modifies the signals as follows:
+ * Sets up the local east-north-up frame at `pos'. The axes are derived
+ * by differencing the ECEF positions of nearby points, so we don't need
+ * to care about the handedness of the ECEF axes.
+ */
+static void
+enu_init(enu_t *enu, geo_pos3_t pos)
+{
+	const double d = 0.01;
+	double lat = clamp(pos.lat, -90 + 2 * d, 90 - 2 * d);
+	vect3_t n1 = geo2ecef_mtr(GEO_POS3(lat - d, pos.lon, pos.elev),
+	    &wgs84);
+	vect3_t n2 = geo2ecef_mtr(GEO_POS3(lat + d, pos.lon, pos.elev),
+	    &wgs84);
+	vect3_t e1 = geo2ecef_mtr(GEO_POS3(lat, pos.lon - d, pos.elev),
+	    &wgs84);
+	vect3_t e2 = geo2ecef_mtr(GEO_POS3(lat, pos.lon + d, pos.elev),
+	    &wgs84);
+
+	enu->north = vect3_unit(vect3_sub(n2, n1), NULL);
+	enu->east = vect3_unit(vect3_sub(e2, e1), NULL);
+	enu->up = vect3_unit(vect3_xprod(enu->east, enu->north), NULL);
+	if (vect3_dotprod(enu->up, n1) < 0)
+		enu->up = vect3_neg(enu->up);
+}
+
+static vect3_t
+enu_project(const enu_t *enu, vect3_t v)
+{
+	return (VECT3(vect3_dotprod(v, enu->east),
+	    vect3_dotprod(v, enu->north), vect3_dotprod(v, enu->up)));
+}
+
+static const vect2_t adf_dist_curve[] = {
+    VECT2(NM2MET(0), -50),
+    VECT2(NM2MET(20), -50),
+    VECT2(NM2MET(120), 0),
+    VECT2(NM2MET(130), 0),
+    NULL_VECT2
+};
+static const vect2_t vor_dist_curve[] = {
+    VECT2(NM2MET(0), -20),
+    VECT2(NM2MET(20), -20),
+    VECT2(NM2MET(100), 0),
+    VECT2(NM2MET(120), 0),
+    NULL_VECT2
+};
+static const vect2_t dme_dist_curve[] = {
+    VECT2(NM2MET(0), 0),
+    VECT2(NM2MET(20), 0),
+    VECT2(NM2MET(100), 20),
+    VECT2(NM2MET(120), 20),
+    NULL_VECT2
+};
+static const vect2_t ils_dme_dist_curve[] = {
+    VECT2(NM2MET(0), -9),
+    VECT2(NM2MET(20), -9),
+    VECT2(NM2MET(100), 11),
+    VECT2(NM2MET(120), 11),
+    NULL_VECT2
+};
+static const vect2_t loc_dist_curve[] = {
+    VECT2(NM2MET(0), -30),
+    VECT2(NM2MET(10), -30),
+    VECT2(NM2MET(40), -20),
+    VECT2(NM2MET(50), -20),
+    NULL_VECT2
+};
+static const vect2_t gs_dist_curve[] = {
+    VECT2(NM2MET(0), -25),
+    VECT2(NM2MET(10), -25),
+    VECT2(NM2MET(40), -15),
+    VECT2(NM2MET(50), -15),
+    NULL_VECT2
+};
+static const vect2_t vor_angle_curve[] = {
+    VECT2(-5, -50),
+    VECT2(-2.5, -20),
+    VECT2(0, -10),
+    VECT2(10, -3),
+    VECT2(20, 0),
+    VECT2(30, 0),
+    VECT2(40, -3),
+    VECT2(50, -10),
+    VECT2(60, -20),
+    VECT2(90, -60),
+    NULL_VECT2
+};
+static const vect2_t adf_angle_curve[] = {
+    VECT2(-5, -40),
+    VECT2(-2.5, -15),
+    VECT2(0, -5),
+    VECT2(10, -1),
+    VECT2(20, 0),
+    VECT2(30, 0),
+    VECT2(40, -3),
+    VECT2(50, -5),
+    VECT2(60, -20),
+    VECT2(90, -40),
+    NULL_VECT2
+};
+static const vect2_t loc_rbrg_curve[] = {
+    VECT2(0, 0),
+    VECT2(30, -5),
+    VECT2(60, -10),
+    VECT2(90, -20),
+    VECT2(120, -20),
+    VECT2(160, -10),
+    VECT2(180, -3),
+    NULL_VECT2
+};
+static const vect2_t loc_rbrg_nobc_curve[] = {
+    VECT2(0, 0),
+    VECT2(30, -5),
+    VECT2(60, -15),
+    VECT2(90, -30),
+    NULL_VECT2
+};
+static const vect2_t gs_rbrg_curve[] = {
+    VECT2(0, 0),
+    VECT2(20, -5),
+    VECT2(60, -10),
+    VECT2(90, -40),
+    NULL_VECT2
+};
+
+/*
+ * Returns the constant signal level modification of a navaid candidate
+ * due to the navaid's declared service volume. This suppresses the
+ * transmission level of short-range navaids (by up to 20 dB for VORs),
+ * which avoids too much interference from e.g. VORs intended for
+ * short-range navigation up at the high flight levels. DMEs paired with
+ * an ILS use a separate curve.
+ */
+static double
+navaid_range_db(const rnav_cold_t *rnav)
+{
+	const navaid_t *nav = rnav->navaid;
+
+	switch (nav->type) {
+	case NAVAID_NDB:
+		return (fx_lin_multi(nav->range, adf_dist_curve, B_TRUE));
+	case NAVAID_VOR:
+		return (fx_lin_multi(nav->range, vor_dist_curve, B_TRUE));
+	case NAVAID_DME:
+		return (fx_lin_multi(nav->range, rnav->ils_dme ?
+		    ils_dme_dist_curve : dme_dist_curve, B_TRUE));
+	case NAVAID_LOC:
+		return (fx_lin_multi(nav->range, loc_dist_curve, B_TRUE));
+	case NAVAID_GS:
+		return (fx_lin_multi(nav->range, gs_dist_curve, B_TRUE));
+	default:
+		return (0);
+	}
+}
+
+/*
+ * Applies the geometry-dependent propagation modeling modifiers to the
+ * signal level of candidate `i' in `set'. The constant, service volume-
+ * dependent modifiers (see navaid_range_db) have already been applied
+ * by the caller. Depending on navaid type, this function modifies the
+ * signals as follows:
  *
  * 1) For VORs, when in line-of-sight propagation mode, we simulate the
  *	cone of confusion above the VOR station.
- * 2) For VORs, we suppress the transmission level by up to 20 dB,
- *	depending on the declared service volume for the navaid. This
- *	avoids too much interference from VORs intended for short-range
- *	navigation up at the high flight levels.
- * 3) For DMEs, applies a similar service-volume modification curve to
- *	the signal level. If the DME has a non-NAN `brg' passed as an
+ * 2) For ILS DMEs, if the DME has a non-NAN `brg' passed as an
  *	argument, it is assumed to be a bearing-biased DME and we will
  *	apply the LOC signal curve.
- * 4) For LOCs, applies signal diminishing based on service volume AND
- *	diminishes the signal even more with increasing lateral deviation
+ * 3) For LOCs, diminishes the signal with increasing lateral deviation
  *	from the LOC centerline. If `has_bc' is B_TRUE, this maintains a
  *	somewhat narrower signal beam at the backcourse to the navaid.
  *	If `has_bc' is B_FALSE, no back-beam projection is simulated.
- * 5) For GSes does the same as for LOCs, except that no back-beam
+ * 4) For GSes does the same as for LOCs, except that no back-beam
  *	projection is simulated here.
  */
 static void
-comp_signal_db(radio_navaid_t *rnav, fpp_t *fpp, bool_t has_bc, double brg)
+comp_signal_db(rnav_set_t *set, size_t i, const pose_t *pose, bool_t has_bc,
+    double brg)
 {
-	static const vect2_t adf_dist_curve[] = {
-	    VECT2(NM2MET(0), -50),
-	    VECT2(NM2MET(20), -50),
-	    VECT2(NM2MET(120), 0),
-	    VECT2(NM2MET(130), 0),
-	    NULL_VECT2
-	};
-	static const vect2_t vor_dist_curve[] = {
-	    VECT2(NM2MET(0), -20),
-	    VECT2(NM2MET(20), -20),
-	    VECT2(NM2MET(100), 0),
-	    VECT2(NM2MET(120), 0),
-	    NULL_VECT2
-	};
-	static const vect2_t dme_dist_curve[] = {
-	    VECT2(NM2MET(0), 0),
-	    VECT2(NM2MET(20), 0),
-	    VECT2(NM2MET(100), 20),
-	    VECT2(NM2MET(120), 20),
-	    NULL_VECT2
-	};
-	static const vect2_t ils_dme_dist_curve[] = {
-	    VECT2(NM2MET(0), -9),
-	    VECT2(NM2MET(20), -9),
-	    VECT2(NM2MET(100), 11),
-	    VECT2(NM2MET(120), 11),
-	    NULL_VECT2
-	};
-	static const vect2_t loc_dist_curve[] = {
-	    VECT2(NM2MET(0), -30),
-	    VECT2(NM2MET(10), -30),
-	    VECT2(NM2MET(40), -20),
-	    VECT2(NM2MET(50), -20),
-	    NULL_VECT2
-	};
-	static const vect2_t gs_dist_curve[] = {
-	    VECT2(NM2MET(0), -25),
-	    VECT2(NM2MET(10), -25),
-	    VECT2(NM2MET(40), -15),
-	    VECT2(NM2MET(50), -15),
-	    NULL_VECT2
-	};
-	static const vect2_t loc_rbrg_curve[] = {
-	    VECT2(0, 0),
-	    VECT2(30, -5),
-	    VECT2(60, -10),
-	    VECT2(90, -20),
-	    VECT2(120, -20),
-	    VECT2(160, -10),
-	    VECT2(180, -3),
-	    NULL_VECT2
-	};
-	static const vect2_t loc_rbrg_nobc_curve[] = {
-	    VECT2(0, 0),
-	    VECT2(30, -5),
-	    VECT2(60, -15),
-	    VECT2(90, -30),
-	    NULL_VECT2
-	};
-	static const vect2_t gs_rbrg_curve[] = {
-	    VECT2(0, 0),
-	    VECT2(20, -5),
-	    VECT2(60, -10),
-	    VECT2(90, -40),
-	    NULL_VECT2
-	};
+	rnav_cold_t *rnav = &set->cold[i];
 	const navaid_t *nav = rnav->navaid;
 
 	ASSERT(nav != NULL);
 
 	switch (nav->type) {
 	case NAVAID_NDB:
-	case NAVAID_VOR: {
-		double angle_error = 0;
-		const vect2_t *curve;
-
-		if (rnav->propmode == ITM_PROPMODE_LOS) {
-			geo_pos3_t nav_pos = navaid_get_pos(nav);
-			vect2_t pos_2d = geo2fpp(GEO3_TO_GEO2(nav_pos), fpp);
-			const vect2_t vor_angle_curve[] = {
-			    VECT2(-5, -50),
-			    VECT2(-2.5, -20),
-			    VECT2(0, -10),
-			    VECT2(10, -3),
-			    VECT2(20, 0),
-			    VECT2(30, 0),
-			    VECT2(40, -3),
-			    VECT2(50, -10),
-			    VECT2(60, -20),
-			    VECT2(90, -60),
-			    NULL_VECT2
-			};
-			const vect2_t adf_angle_curve[] = {
-			    VECT2(-5, -40),
-			    VECT2(-2.5, -15),
-			    VECT2(0, -5),
-			    VECT2(10, -1),
-			    VECT2(20, 0),
-			    VECT2(30, 0),
-			    VECT2(40, -3),
-			    VECT2(50, -5),
-			    VECT2(60, -20),
-			    VECT2(90, -40),
-			    NULL_VECT2
-			};
-			const vect2_t *angle_curve;
-
-			rnav->radial_degt = dir2hdg(pos_2d);
-			rnav->gnd_dist = MAX(vect2_abs(pos_2d), 1);
-			rnav->slant_angle = RAD2DEG(atan((navrad.pos.elev -
-			    nav_pos.elev) / rnav->gnd_dist));
-			angle_curve = (nav->type == NAVAID_VOR ?
-			    vor_angle_curve : adf_angle_curve);
-			angle_error = fx_lin_multi(rnav->slant_angle,
-			    angle_curve, B_TRUE);
+	case NAVAID_VOR:
+		if (set->propmode[i] == ITM_PROPMODE_LOS) {
+			rnav->radial_degt = brg2navaid(pose, rnav,
+			    &rnav->gnd_dist, NULL);
+			rnav->gnd_dist = MAX(rnav->gnd_dist, 1);
+			rnav->slant_angle = RAD2DEG(atan((pose->pos.elev -
+			    nav->pos.elev) / rnav->gnd_dist));
+			set->signal_db[i] += fx_lin_multi(rnav->slant_angle,
+			    nav->type == NAVAID_VOR ? vor_angle_curve :
+			    adf_angle_curve, B_TRUE);
 		}
-
-		curve = (nav->type == NAVAID_VOR ? vor_dist_curve :
-		    adf_dist_curve);
-		rnav->signal_db = rnav->signal_db_omni + angle_error +
-		    fx_lin_multi(nav->range, curve, B_TRUE);
 		break;
-	}
 	case NAVAID_DME:
-		if (is_valid_loc_freq(nav->freq / 1000000.0)) {
-			rnav->signal_db = rnav->signal_db_omni +
-			    fx_lin_multi(nav->range, ils_dme_dist_curve,
-			    B_TRUE);
-			if (!isnan(brg)) {
-				/*
-				 * On directional & paired DMEs, apply
-				 * appropriate bearing bias to the signal
-				 * level (especially important for opposing
-				 * runways using the same ILS frequency!)
-				 */
-				double brg_fm_nav = brg2navaid(nav, NULL, NULL);
-				double rbrg = fabs(rel_hdg(brg, brg_fm_nav));
-				if (has_bc) {
-					rnav->signal_db += fx_lin_multi(rbrg,
-					    loc_rbrg_curve, B_TRUE);
-				} else {
-					rnav->signal_db += fx_lin_multi(rbrg,
-					    loc_rbrg_nobc_curve, B_TRUE);
-				}
-			}
-		} else {
-			rnav->signal_db = rnav->signal_db_omni +
-			    fx_lin_multi(nav->range, dme_dist_curve, B_TRUE);
+		if (rnav->ils_dme && !isnan(brg)) {
+			/*
+			 * On directional & paired DMEs, apply appropriate
+			 * bearing bias to the signal level (especially
+			 * important for opposing runways using the same
+			 * ILS frequency!)
+			 */
+			double brg_fm_nav = brg2navaid(pose, rnav, NULL, NULL);
+			double rbrg = fabs(rel_hdg(brg, brg_fm_nav));
+
+			set->signal_db[i] += fx_lin_multi(rbrg, has_bc ?
+			    loc_rbrg_curve : loc_rbrg_nobc_curve, B_TRUE);
 		}
 		break;
-	case NAVAID_LOC:
+	case NAVAID_LOC: {
+		double brg_fm_nav = brg2navaid(pose, rnav, NULL, NULL);
+		double rbrg = fabs(rel_hdg(nav->loc.brg, brg_fm_nav));
+
+		set->signal_db[i] += fx_lin_multi(rbrg, has_bc ?
+		    loc_rbrg_curve : loc_rbrg_nobc_curve, B_TRUE);
+		break;
+	}
 	case NAVAID_GS: {
-		double crs = (nav->type == NAVAID_LOC ? nav->loc.brg :
-		    nav->gs.brg);
-		double brg_fm_nav = brg2navaid(nav, NULL, NULL);
-		double rbrg = fabs(rel_hdg(crs, brg_fm_nav));
-		double signal_db = rnav->signal_db_omni;
-
-		if (nav->type == NAVAID_LOC) {
-			if (has_bc) {
-				signal_db += fx_lin_multi(rbrg,
-				    loc_rbrg_curve, B_TRUE);
-			} else {
-				signal_db += fx_lin_multi(rbrg,
-				    loc_rbrg_nobc_curve, B_TRUE);
-			}
-			signal_db += fx_lin_multi(nav->range, loc_dist_curve,
-			    B_TRUE);
-		} else {
-			signal_db += fx_lin_multi(rbrg, gs_rbrg_curve, B_TRUE);
-			signal_db += fx_lin_multi(nav->range, gs_dist_curve,
-			    B_TRUE);
-		}
+		double brg_fm_nav = brg2navaid(pose, rnav, NULL, NULL);
+		double rbrg = fabs(rel_hdg(nav->gs.brg, brg_fm_nav));
 
-		rnav->signal_db = signal_db;
+		set->signal_db[i] += fx_lin_multi(rbrg, gs_rbrg_curve, B_TRUE);
 		break;
 	}
 	default:
-		rnav->signal_db = rnav->signal_db_omni;
 		break;
 	}
 }
 
-static void
-audio_buf_chunks_encode(radio_navaid_t *rnav)
+static inline void
+morse_pat_key(morse_pat_t *pat, int from, int n)
 {
-	const navaid_t *nav = rnav->navaid;
-
-	memset(rnav->audio_chunks, 0, sizeof (rnav->audio_chunks));
+	for (int i = from; i < from + n; i++)
+		pat->gate[i / 64] |= 1ull << (i % 64);
+}
 
-	for (int i = 0, j = 0, n = MIN(strlen(nav->id), 5); i < n; i++) {
-		char c = nav->id[i];
+static void
+morse_pat_encode(morse_pat_t *pat)
+{
+	for (int i = 0, j = 0, n = strlen(pat->id); i < n; i++) {
+		char c = pat->id[i];
 		const char *codestr;
 
 		if (c >= '0' && c <= '9')
@@ -831,12 +1148,12 @@ audio_buf_chunks_encode(radio_navaid_t *rnav)
 		for (int k = 0, nk = strlen(codestr); k < nk; k++) {
 			if (codestr[k] == '0') {
 				/* dash: 300 ms */
-				rnav->audio_chunks[j++] = 1;
-				rnav->audio_chunks[j++] = 1;
-				rnav->audio_chunks[j++] = 1;
+				morse_pat_key(pat, j, 3);
+				j += 3;
 			} else {
 				/* dot: 100 ms */
-				rnav->audio_chunks[j++] = 1;
+				morse_pat_key(pat, j, 1);
+				j++;
 			}
 			j++;
 		}
@@ -847,25 +1164,54 @@ audio_buf_chunks_encode(radio_navaid_t *rnav)
 }
 
 /*
- * Locates a navaid which might be conflicting with `rnav' in tree `tree'.
+ * Returns the encoded morse pattern of `nav's ident, encoding it only
+ * the first time the ident is seen. Retuning through a band thus only
+ * costs a hash lookup per new candidate.
+ */
+static const morse_pat_t *
+morse_pat_get(const navaid_t *nav)
+{
+	char key[MORSE_MAX_CHARS + 1] = {};
+	morse_pat_t *pat;
+
+	ASSERT(inited);
+	strncpy(key, nav->id, MORSE_MAX_CHARS);
+	pat = htbl_lookup(&navrad.morse_pats, key);
+	if (pat == NULL) {
+		pat = safe_calloc(1, sizeof (*pat));
+		memcpy(pat->id, key, sizeof (pat->id));
+		morse_pat_encode(pat);
+		htbl_set(&navrad.morse_pats, pat->id, pat);
+	}
+	return (pat);
+}
+
+static void
+morse_pat_free(void *pat, void *unused)
+{
+	UNUSED(unused);
+	free(pat);
+}
+
+/*
+ * Locates a navaid which might be conflicting with candidate `idx' in `set'.
  * This is used to locate conflicting opposite-facing LOC transmitters and
  * disable back-beam simulation. IRL these two transmitters would never be
  * run at the same time, but we don't know which one is currently in use,
  * so we instead modify the transmission diagram to kill the back-beam.
  */
 static const navaid_t *
-find_conflicting_navaid(avl_tree_t *tree, radio_navaid_t *rnav)
+find_conflicting_navaid(const rnav_set_t *set, size_t idx)
 {
-	const navaid_t *nav = rnav->navaid;
+	const navaid_t *nav = set->cold[idx].navaid;
 
 	if (nav->type != NAVAID_LOC && nav->type != NAVAID_DME)
 		return (NULL);
 
-	for (radio_navaid_t *oth_rnav = avl_first(tree); oth_rnav != NULL;
-	    oth_rnav = AVL_NEXT(tree, oth_rnav)) {
-		const navaid_t *oth_nav = oth_rnav->navaid;
+	for (size_t i = 0; i < set->num_navaids; i++) {
+		const navaid_t *oth_nav = set->cold[i].navaid;
 
-		if (oth_rnav == rnav)
+		if (i == idx)
 			continue;
 		if (strcmp(oth_nav->icao, nav->icao) == 0)
 			return (oth_nav);
@@ -875,15 +1221,12 @@ find_conflicting_navaid(avl_tree_t *tree, radio_navaid_t *rnav)
 }
 
 static double
-find_paired_loc_brg(avl_tree_t *tree, radio_navaid_t *rnav)
+find_paired_loc_brg(const rnav_set_t *vlocs, const navaid_t *nav)
 {
-	const navaid_t *nav = rnav->navaid;
-
 	ASSERT3U(nav->type, ==, NAVAID_DME);
 
-	for (radio_navaid_t *oth_rnav = avl_first(tree); oth_rnav != NULL;
-	    oth_rnav = AVL_NEXT(tree, oth_rnav)) {
-		const navaid_t *oth_nav = oth_rnav->navaid;
+	for (size_t i = 0; i < vlocs->num_navaids; i++) {
+		const navaid_t *oth_nav = vlocs->cold[i].navaid;
 
 		if (oth_nav->type == NAVAID_LOC &&
 		    strcmp(nav->id, oth_nav->id) == 0 &&
@@ -896,23 +1239,22 @@ find_paired_loc_brg(avl_tree_t *tree, radio_navaid_t *rnav)
 }
 
 static bool_t
-shutoff_conflicting_NDB(const navaid_t *nav)
+shutoff_conflicting_NDB(const pose_t *pose, const navaid_t *nav,
+    const navaid_t *nav2)
 {
-	const navaid_t *nav2;
 	double d1, d2;
 
 	ASSERT(nav != NULL);
-	nav2 = navaiddb_find_conflict_same_arpt(navrad.db, nav);
-	if (nav2 == NULL)
-		return (B_FALSE);
-	d1 = gc_distance(TO_GEO2(navrad.pos), TO_GEO2(nav->pos));
-	d2 = gc_distance(TO_GEO2(navrad.pos), TO_GEO2(nav2->pos));
+	ASSERT(nav2 != NULL);
+	d1 = vect3_abs(vect3_sub(pose->ecef, nav->ecef));
+	d2 = vect3_abs(vect3_sub(pose->ecef, nav2->ecef));
 
 	return (d1 > d2);
 }
 
 static bool_t
-shutoff_conflicting_LOC(const navaid_t *nav1, const navaid_t *nav2)
+shutoff_conflicting_LOC(const pose_t *pose, const navaid_t *nav1,
+    const navaid_t *nav2)
 {
 	ASSERT(nav1 != NULL);
 	ASSERT(nav2 != NULL);
@@ -923,10 +1265,9 @@ shutoff_conflicting_LOC(const navaid_t *nav1, const navaid_t *nav2)
 	 * transmitter. This way, we'll switch localizers only
 	 * when passing abeam the runway midpoint.
 	 */
-	if (navrad.hgt_agl >= FEET2MET(100)) {
-		geo_pos2_t my_pos = TO_GEO2(navrad.pos);
-		double d1 = gc_distance(my_pos, TO_GEO2(nav1->pos));
-		double d2 = gc_distance(my_pos, TO_GEO2(nav2->pos));
+	if (pose->hgt_agl >= FEET2MET(100)) {
+		double d1 = vect3_abs(vect3_sub(pose->ecef, nav1->ecef));
+		double d2 = vect3_abs(vect3_sub(pose->ecef, nav2->ecef));
 		return (d1 < d2);
 	} else {
 		/*
@@ -935,66 +1276,169 @@ shutoff_conflicting_LOC(const navaid_t *nav1, const navaid_t *nav2)
 		 * facilitate autolands. So in that case, we simply go based
 		 * on whichever station bearing we are closer to.
 		 */
-		double rbrg1 = rel_hdg(navrad.hdgt, nav1->loc.brg);
-		double rbrg2 = rel_hdg(navrad.hdgt, nav2->loc.brg);
+		double rbrg1 = rel_hdg(pose->hdgt, nav1->loc.brg);
+		double rbrg2 = rel_hdg(pose->hdgt, nav2->loc.brg);
 		return (fabs(rbrg1) > fabs(rbrg2));
 	}
 }
 
 static bool_t
-navaid_is_failed(const char *ID, navaid_type_t type)
+navaid_fail_key(const char *ID, char key[NAVAID_FAIL_ID_LEN])
+{
+	memset(key, 0, NAVAID_FAIL_ID_LEN);
+	if (strlen(ID) >= NAVAID_FAIL_ID_LEN)
+		return (B_FALSE);
+	strlcpy(key, ID, NAVAID_FAIL_ID_LEN);
+	return (B_TRUE);
+}
+
+static bool_t
+navaid_is_failed_impl(const char *ID, navaid_type_t type)
 {
-	bool_t result = B_FALSE;
+	char key[NAVAID_FAIL_ID_LEN];
+	const list_t *l;
 
 	ASSERT(ID != NULL);
 
+	if (!navaid_fail_key(ID, key))
+		return (B_FALSE);
+	l = htbl_lookup_multi(&navaid_fail.by_id, key);
+	if (l == NULL)
+		return (B_FALSE);
+	for (void *v = list_head(l); v != NULL; v = list_next(l, v)) {
+		const navaid_fail_t *fail = HTBL_VALUE_MULTI(v);
+
+		if ((fail->type & type) && fail->failed)
+			return (B_TRUE);
+	}
+	return (B_FALSE);
+}
+
+static bool_t
+navaid_is_failed(const char *ID, navaid_type_t type)
+{
+	bool_t result;
+
 	mutex_enter(&navaid_fail.lock);
-	for (int i = 0; i < NUM_NAVAID_FAILS; i++) {
-		if (strcmp(navaid_fail.ID[i], ID) == 0 &&
-		    (navaid_fail.type[i] & type) && navaid_fail.failed[i]) {
-			result = B_TRUE;
+	result = navaid_is_failed_impl(ID, type);
+	mutex_exit(&navaid_fail.lock);
+
+	return (result);
+}
+
+static void
+navaid_fail_hash(navaid_fail_t *fail)
+{
+	ASSERT(!fail->hashed);
+	if (fail->ID[0] != '\0') {
+		htbl_set(&navaid_fail.by_id, fail->ID, fail);
+		fail->hashed = B_TRUE;
+	}
+}
+
+static void
+navaid_fail_unhash(navaid_fail_t *fail)
+{
+	const list_t *l;
+
+	if (!fail->hashed)
+		return;
+	l = htbl_lookup_multi(&navaid_fail.by_id, fail->ID);
+	ASSERT(l != NULL);
+	for (void *v = list_head(l); v != NULL; v = list_next(l, v)) {
+		if (HTBL_VALUE_MULTI(v) == fail) {
+			htbl_remove_multi(&navaid_fail.by_id, fail->ID, v);
 			break;
 		}
 	}
-	mutex_exit(&navaid_fail.lock);
+	fail->hashed = B_FALSE;
+}
 
-	return (result);
+/*
+ * Must be called after every change to the failure set, with
+ * navaid_fail.lock held.
+ */
+static void
+navaid_fail_changed(void)
+{
+	atomic_fetch_add_explicit(&navaid_fail.gen, 1, memory_order_release);
+}
+
+/*
+ * Selects the two strongest candidates in a set. No receive floor is
+ * applied here. Filtering the top two by a floor gives the same result
+ * as selecting among the candidates above that floor, so
+ * radio_get_strongest_navaid can apply its floor afterwards.
+ */
+static void
+rnav_set_select(rnav_set_t *set)
+{
+	const double *signal_db = set->signal_db;
+	int strongest = -1, second = -1;
+
+	for (size_t i = 0; i < set->num_navaids; i++) {
+		if (strongest == -1) {
+			strongest = i;
+		} else if (signal_db[i] > signal_db[strongest]) {
+			second = strongest;
+			strongest = i;
+		} else if (second == -1 || signal_db[i] > signal_db[second]) {
+			second = i;
+		}
+	}
+	set->strongest = strongest;
+	set->second = second;
 }
 
 static void
-signal_levels_update(avl_tree_t *tree, double d_t, fpp_t *fpp,
-    avl_tree_t *vlocs_tree)
+signal_levels_update(rnav_set_t *set, double d_t, const pose_t *pose)
 {
-	for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-	    rnav = AVL_NEXT(tree, rnav)) {
-		const navaid_t *nav2 = find_conflicting_navaid(tree, rnav);
+	unsigned fail_gen = atomic_load_explicit(&navaid_fail.gen,
+	    memory_order_acquire);
+
+	/*
+	 * Smooth out the stepwise worker output and apply the constant
+	 * signal modifiers first. This is a simple linear pass over the
+	 * hot arrays only.
+	 */
+	for (size_t i = 0; i < set->num_navaids; i++) {
+		FILTER_IN(set->signal_db_omni[i], set->signal_db_tgt[i], d_t,
+		    USEC2SEC(WORKER_INTVAL));
+		set->signal_db[i] = set->signal_db_omni[i] + set->range_db[i];
+	}
+
+	for (size_t i = 0; i < set->num_navaids; i++) {
+		rnav_cold_t *rnav = &set->cold[i];
+		const navaid_t *nav = rnav->navaid;
+		const navaid_t *nav2 = rnav->conflict;
 		bool_t has_bc = (nav2 == NULL);
-		double brg = NAN;
 
-		if (rnav->radio->type == NAVRAD_TYPE_ADF &&
-		    shutoff_conflicting_NDB(rnav->navaid)) {
+		if (rnav->ndb_conflict != NULL &&
+		    shutoff_conflicting_NDB(pose, nav, rnav->ndb_conflict)) {
 			/*
 			 * Special case handling - some airports use same-
 			 * frequency NDBs.
 			 */
-			rnav->signal_db = -200;
+			set->signal_db[i] = -200;
 			continue;
 		}
 		if (nav2 != NULL && nav2->type == NAVAID_LOC &&
-		    shutoff_conflicting_LOC(rnav->navaid, nav2)) {
-			rnav->signal_db = -200;
+		    shutoff_conflicting_LOC(pose, nav, nav2)) {
+			set->signal_db[i] = -200;
 			continue;
 		}
-		if (navaid_is_failed(rnav->navaid->id, rnav->navaid->type)) {
-			rnav->signal_db = -200;
+		if (rnav->fail_gen != fail_gen) {
+			rnav->failed = navaid_is_failed(nav->id, nav->type);
+			rnav->fail_gen = fail_gen;
+		}
+		if (rnav->failed) {
+			set->signal_db[i] = -200;
 			continue;
 		}
-		if (vlocs_tree != NULL)
-			brg = find_paired_loc_brg(vlocs_tree, rnav);
-		FILTER_IN(rnav->signal_db_omni, rnav->signal_db_tgt, d_t,
-		    USEC2SEC(WORKER_INTVAL));
-		comp_signal_db(rnav, fpp, has_bc, brg);
+		comp_signal_db(set, i, pose, has_bc, rnav->paired_loc_brg);
 	}
+
+	rnav_set_select(set);
 }
 
 static bool_t
@@ -1007,7 +1451,7 @@ radio_adf_is_ant_mode(radio_t *radio)
 
 #if	USE_XPLANE_RADIO_DRS
 static void
-ap_drs_config(double d_t)
+ap_drs_config(const pose_t *pose, double d_t)
 {
 #if	LIBRADIO_APCTL
 	int ap_state = dr_geti(&drs.ap_state);
@@ -1019,11 +1463,11 @@ ap_drs_config(double d_t)
 
 	switch (hsi_sel) {
 	case 0:
-		radio = &navrad.vloc_radios[0];
-		break;
 	case 1:
-		radio = &navrad.vloc_radios[1];
-		break;
+		radio = radio_lookup(NAVRAD_TYPE_VLOC, hsi_sel);
+		if (radio != NULL)
+			break;
+		/*FALLTHROUGH*/
 	default:
 #if	LIBRADIO_APCTL
 		dr_seti(&drs.ovrd_nav_heading, 0);
@@ -1046,7 +1490,7 @@ ap_drs_config(double d_t)
 	FILTER_IN(navrad.ap.hdef_rate, (hdef - navrad.ap.hdef_prev) / d_t, d_t,
 	    HDEF_RATE_UPD_RATE(radio->signal_db));
 	beta = rel_hdg(normalize_hdg(dr_getf_prot(&drs.hpath)),
-	    normalize_hdg(dr_getf_prot(&drs.hdg)));
+	    pose->hdgt);
 	if (is_loc) {
 		const vect2_t sens[] = {
 		    VECT2(0, 24),
@@ -1218,19 +1662,482 @@ ap_radio_drs_config(radio_t *radio, double d_t)
 }
 #endif	/* USE_XPLANE_RADIO_DRS */
 
-static void
-radio_floop_cb(radio_t *radio, double d_t)
+/*
+ * Picks up the latest worker result for the radio, if the worker has
+ * published one since our last call. Returns NULL otherwise. The returned
+ * result is owned by the flight loop until the next call.
+ */
+static wk_res_t *
+radio_wk_res_consume(radio_t *radio)
 {
-	uint64_t new_freq;
-	fpp_t fpp = ortho_fpp_init(GEO3_TO_GEO2(navrad.pos), 0, &wgs84,
-	    B_FALSE);
+	unsigned mid;
 
-#if	USE_XPLANE_RADIO_DRS
-	switch (radio->type) {
-	case NAVRAD_TYPE_VLOC:
-		new_freq = dr_getf_prot(&radio->drs.vloc.freq) * 10000;
-		break;
-	case NAVRAD_TYPE_ADF:
+	if ((atomic_load_explicit(&radio->wk_mid, memory_order_relaxed) &
+	    WK_RES_FRESH) == 0) {
+		return (NULL);
+	}
+	mid = atomic_exchange_explicit(&radio->wk_mid, radio->wk_front,
+	    memory_order_acq_rel);
+	ASSERT(mid & WK_RES_FRESH);
+	radio->wk_front = (mid & ~WK_RES_FRESH);
+
+	return (&radio->wk_res[radio->wk_front]);
+}
+
+/*
+ * Publishes the worker's back buffer to the flight loop and grabs
+ * whatever buffer was sitting in the middle slot as the new back buffer.
+ */
+static void
+radio_wk_res_publish(radio_t *radio)
+{
+	unsigned mid = atomic_exchange_explicit(&radio->wk_mid,
+	    radio->wk_back | WK_RES_FRESH, memory_order_acq_rel);
+	radio->wk_back = (mid & ~WK_RES_FRESH);
+}
+
+static void
+rnav_set_init(rnav_set_t *set, radio_t *radio)
+{
+	memset(set, 0, sizeof (*set));
+	set->radio = radio;
+	set->strongest = -1;
+	set->second = -1;
+}
+
+static void
+rnav_set_fini(rnav_set_t *set)
+{
+	free(set->signal_db);
+	free(set->signal_db_omni);
+	free(set->signal_db_tgt);
+	free(set->range_db);
+	free(set->propmode);
+	free(set->audio_chunk_phase);
+	free(set->cold);
+	memset(set, 0, sizeof (*set));
+}
+
+static void
+rnav_set_reserve(rnav_set_t *set, size_t cap)
+{
+	if (cap <= set->cap)
+		return;
+	set->cap = MAX(cap, 2 * set->cap);
+#define	REALLOC_ARRAY(field) \
+	set->field = safe_realloc(set->field, set->cap * sizeof (*set->field))
+	REALLOC_ARRAY(signal_db);
+	REALLOC_ARRAY(signal_db_omni);
+	REALLOC_ARRAY(signal_db_tgt);
+	REALLOC_ARRAY(range_db);
+	REALLOC_ARRAY(propmode);
+	REALLOC_ARRAY(audio_chunk_phase);
+	REALLOC_ARRAY(cold);
+#undef	REALLOC_ARRAY
+}
+
+static void
+rnav_set_move(rnav_set_t *set, size_t dst, size_t src)
+{
+	if (dst == src)
+		return;
+	set->signal_db[dst] = set->signal_db[src];
+	set->signal_db_omni[dst] = set->signal_db_omni[src];
+	set->signal_db_tgt[dst] = set->signal_db_tgt[src];
+	set->range_db[dst] = set->range_db[src];
+	set->propmode[dst] = set->propmode[src];
+	set->audio_chunk_phase[dst] = set->audio_chunk_phase[src];
+	set->cold[dst] = set->cold[src];
+}
+
+/*
+ * Merges a worker result list into one of the radio's candidate sets.
+ * New navaids get added, navaids no longer present in the list are
+ * dropped and everybody else simply receives the new signal target.
+ * Returns B_TRUE if the set of candidates has changed.
+ * Both the set and the list are sorted by navaid pointer, so this is
+ * done in two linear passes without any temporary storage: a forward
+ * pass which compacts out the dropped candidates, followed by a
+ * backward pass which opens up gaps for new candidates in place.
+ */
+static bool_t
+rnav_set_merge(rnav_set_t *set, const wk_list_t *list)
+{
+	bool_t changed;
+	size_t n_kept = 0, n_total, i;
+
+	/* drop candidates missing from the list, update the rest */
+	for (size_t si = 0, li = 0; si < set->num_navaids; si++) {
+		const navaid_t *nav = set->cold[si].navaid;
+
+		while (li < list->num_navaids &&
+		    (uintptr_t)list->navaids[li].navaid < (uintptr_t)nav)
+			li++;
+		if (li == list->num_navaids || list->navaids[li].navaid != nav)
+			continue;
+		rnav_set_move(set, n_kept, si);
+		set->signal_db_tgt[n_kept] = list->navaids[li].signal_db_tgt;
+		set->propmode[n_kept] = list->navaids[li].propmode;
+		set->cold[n_kept].terr_elev = list->navaids[li].terr_elev;
+		n_kept++;
+	}
+	ASSERT3U(n_kept, <=, list->num_navaids);
+	n_total = list->num_navaids;
+	rnav_set_reserve(set, n_total);
+
+	/*
+	 * Insert new candidates, working back-to-front. Candidate `k'
+	 * of the final set corresponds to list entry `k', while `i' counts
+	 * down the kept candidates which haven't been moved yet.
+	 */
+	i = n_kept;
+	for (size_t k = n_total; k-- > 0;) {
+		const wk_navaid_t *wnav = &list->navaids[k];
+		rnav_cold_t *rnav;
+
+		if (i > 0 && set->cold[i - 1].navaid == wnav->navaid) {
+			rnav_set_move(set, k, --i);
+			continue;
+		}
+		ASSERT(i == 0 || (uintptr_t)set->cold[i - 1].navaid <
+		    (uintptr_t)wnav->navaid);
+		rnav = &set->cold[k];
+		memset(rnav, 0, sizeof (*rnav));
+		rnav->navaid = wnav->navaid;
+		rnav->ils_dme = (wnav->navaid->type == NAVAID_DME &&
+		    is_valid_loc_freq(wnav->navaid->freq / 1000000.0));
+		rnav->ecef = navaid_get_ecef(wnav->navaid);
+		enu_init(&rnav->enu, navaid_get_pos(wnav->navaid));
+		rnav->morse = morse_pat_get(wnav->navaid);
+		set->audio_chunk_phase[k] = crc64_rand() % AUDIO_BUF_NUM_CHUNKS;
+		set->signal_db[k] = NOISE_FLOOR_TOO_FAR;
+		set->signal_db_omni[k] = NOISE_FLOOR_TOO_FAR;
+		set->signal_db_tgt[k] = wnav->signal_db_tgt;
+		set->range_db[k] = navaid_range_db(rnav);
+		set->propmode[k] = wnav->propmode;
+		rnav->terr_elev = wnav->terr_elev;
+	}
+	ASSERT0(i);
+	changed = (n_kept != set->num_navaids || n_kept != n_total);
+	set->num_navaids = n_total;
+	/* indices have moved, wait for the next rnav_set_select */
+	set->strongest = -1;
+	set->second = -1;
+
+	return (changed);
+}
+
+static void
+radio_dr_slots_populate(radio_t *radio, const rnav_set_t *set,
+    unsigned *slot_p)
+{
+	for (size_t i = 0; i < set->num_navaids && *slot_p < MAX_DR_VALS;
+	    i++) {
+		const navaid_t *nav = set->cold[i].navaid;
+		unsigned nr = (*slot_p)++;
+
+		strlcpy(radio->dr_vals[nr].id, nav->id,
+		    sizeof (radio->dr_vals[nr].id));
+		radio->dr_vals[nr].type = nav->type;
+		radio->dr_vals[nr].signal_db = set->signal_db[i];
+		radio->dr_vals[nr].propmode = set->propmode[i];
+	}
+}
+
+static void
+radio_dr_vals_update(radio_t *radio)
+{
+	unsigned slot = 0;
+
+	switch (radio->type) {
+	case NAVRAD_TYPE_VLOC:
+		radio_dr_slots_populate(radio, &radio->vlocs, &slot);
+		radio_dr_slots_populate(radio, &radio->gses, &slot);
+		radio_dr_slots_populate(radio, &radio->dmes, &slot);
+		break;
+	case NAVRAD_TYPE_ADF:
+		radio_dr_slots_populate(radio, &radio->adfs, &slot);
+		break;
+	case NAVRAD_TYPE_DME:
+		radio_dr_slots_populate(radio, &radio->vlocs, &slot);
+		radio_dr_slots_populate(radio, &radio->dmes, &slot);
+		break;
+	}
+	for (; slot < MAX_DR_VALS; slot++) {
+		radio->dr_vals[slot].id[0] = '\0';
+		radio->dr_vals[slot].type = 0;
+		radio->dr_vals[slot].signal_db = 0;
+		radio->dr_vals[slot].propmode = 0;
+	}
+}
+
+static void
+rnav_set_links_update(rnav_set_t *set, const rnav_set_t *vlocs,
+    navaiddb_t *db)
+{
+	for (size_t i = 0; i < set->num_navaids; i++) {
+		rnav_cold_t *rnav = &set->cold[i];
+
+		rnav->conflict = find_conflicting_navaid(set, i);
+		if (set->radio->type == NAVRAD_TYPE_ADF) {
+			rnav->ndb_conflict = navaiddb_find_conflict_same_arpt(
+			    db, rnav->navaid);
+		} else {
+			rnav->ndb_conflict = NULL;
+		}
+		if (vlocs != NULL)
+			rnav->paired_loc_brg = find_paired_loc_brg(vlocs,
+			    rnav->navaid);
+		else
+			rnav->paired_loc_brg = NAN;
+	}
+}
+
+static void
+radio_rnav_links_update(radio_t *radio)
+{
+	navaiddb_t *db = radio->db->db;
+
+	switch (radio->type) {
+	case NAVRAD_TYPE_VLOC:
+		rnav_set_links_update(&radio->vlocs, NULL, db);
+		rnav_set_links_update(&radio->gses, NULL, db);
+		rnav_set_links_update(&radio->dmes, &radio->vlocs, db);
+		break;
+	case NAVRAD_TYPE_ADF:
+		rnav_set_links_update(&radio->adfs, NULL, db);
+		break;
+	case NAVRAD_TYPE_DME:
+		rnav_set_links_update(&radio->vlocs, NULL, db);
+		rnav_set_links_update(&radio->dmes, &radio->vlocs, db);
+		break;
+	}
+}
+
+/*
+ * A candidate's navaid and its index in its set, for looking up
+ * candidates by station identity in rnav_set_carry_over.
+ */
+typedef struct {
+	const navaid_t	*navaid;
+	size_t		idx;
+} rnav_ident_t;
+
+/*
+ * Orders candidates by the fields which identify a station regardless
+ * of which navaid database it came from.
+ */
+static int
+rnav_ident_compar(const void *a, const void *b)
+{
+	const navaid_t *na = ((const rnav_ident_t *)a)->navaid;
+	const navaid_t *nb = ((const rnav_ident_t *)b)->navaid;
+	int res;
+
+	if (na->type != nb->type)
+		return (na->type < nb->type ? -1 : 1);
+	if (na->freq != nb->freq)
+		return (na->freq < nb->freq ? -1 : 1);
+	if ((res = strcmp(na->id, nb->id)) != 0)
+		return (res);
+	if ((res = strcmp(na->icao, nb->icao)) != 0)
+		return (res);
+	return (strcmp(na->region, nb->region));
+}
+
+/*
+ * Carries over the signal state of candidates from `old' to the
+ * candidates in `set' which represent the same station in a different
+ * navaid database. This way a database swap doesn't make the radio lose
+ * and then slowly reacquire the stations it's receiving. The sets can
+ * be arbitrarily large (navrad_set_max_candidates(0) means unlimited),
+ * so rather than comparing every pair of candidates, the old ones are
+ * sorted by station identity and looked up by binary search.
+ */
+static void
+rnav_set_carry_over(rnav_set_t *set, const rnav_set_t *old)
+{
+	rnav_ident_t *idents;
+
+	if (set->num_navaids == 0 || old->num_navaids == 0)
+		return;
+	idents = safe_malloc(old->num_navaids * sizeof (*idents));
+	for (size_t j = 0; j < old->num_navaids; j++) {
+		idents[j].navaid = old->cold[j].navaid;
+		idents[j].idx = j;
+	}
+	qsort(idents, old->num_navaids, sizeof (*idents), rnav_ident_compar);
+	for (size_t i = 0; i < set->num_navaids; i++) {
+		rnav_ident_t key = { .navaid = set->cold[i].navaid };
+		const rnav_ident_t *match = bsearch(&key, idents,
+		    old->num_navaids, sizeof (*idents), rnav_ident_compar);
+		size_t j;
+
+		if (match == NULL)
+			continue;
+		j = match->idx;
+		set->signal_db[i] = old->signal_db[j];
+		set->signal_db_omni[i] = old->signal_db_omni[j];
+		set->audio_chunk_phase[i] = old->audio_chunk_phase[j];
+	}
+	free(idents);
+}
+
+/*
+ * Rebuilds a candidate set from a worker result from a different
+ * navaid database than the one the set's navaids are from.
+ */
+static void
+rnav_set_swap_db(rnav_set_t *set, const wk_list_t *list)
+{
+	rnav_set_t old = *set;
+
+	rnav_set_init(set, old.radio);
+	rnav_set_merge(set, list);
+	rnav_set_carry_over(set, &old);
+	rnav_set_fini(&old);
+}
+
+static void
+radio_wk_res_merge(radio_t *radio, const wk_res_t *res)
+{
+	bool_t changed = B_FALSE;
+
+	if (res->db != radio->db) {
+		/*
+		 * The navaid database was swapped. All our candidates are
+		 * from the old one, so we rebuild all sets at once before
+		 * we can let go of it.
+		 */
+		rnav_set_swap_db(&radio->vlocs, &res->vlocs);
+		rnav_set_swap_db(&radio->gses, &res->gses);
+		rnav_set_swap_db(&radio->dmes, &res->dmes);
+		rnav_set_swap_db(&radio->adfs, &res->adfs);
+		navrad_db_hold(res->db);
+		if (radio->db != NULL)
+			navrad_db_rele(radio->db);
+		radio->db = res->db;
+		radio_rnav_links_update(radio);
+		radio_dr_vals_update(radio);
+		return;
+	}
+
+	switch (radio->type) {
+	case NAVRAD_TYPE_VLOC:
+		changed |= rnav_set_merge(&radio->vlocs, &res->vlocs);
+		changed |= rnav_set_merge(&radio->gses, &res->gses);
+		changed |= rnav_set_merge(&radio->dmes, &res->dmes);
+		break;
+	case NAVRAD_TYPE_ADF:
+		changed |= rnav_set_merge(&radio->adfs, &res->adfs);
+		break;
+	case NAVRAD_TYPE_DME:
+		changed |= rnav_set_merge(&radio->vlocs, &res->vlocs);
+		changed |= rnav_set_merge(&radio->dmes, &res->dmes);
+		break;
+	}
+	if (changed)
+		radio_rnav_links_update(radio);
+	radio_dr_vals_update(radio);
+}
+
+/*
+ * Returns the candidate set which produces the audible identifier for
+ * the radio.
+ */
+static const rnav_set_t *
+radio_audio_set(radio_t *radio)
+{
+	switch (radio->type) {
+	case NAVRAD_TYPE_VLOC:
+		return (&radio->vlocs);
+	case NAVRAD_TYPE_ADF:
+		return (&radio->adfs);
+	default:
+		ASSERT3U(radio->type, ==, NAVRAD_TYPE_DME);
+		return (&radio->dmes);
+	}
+}
+
+/*
+ * Writer side of the audio seqlock. We always write into the snapshot
+ * which the audio threads aren't supposed to be reading right now and
+ * then flip `audio_gen' over to it. A reader which was still copying
+ * out that snapshot from two generations ago will notice the generation
+ * change and simply retry.
+ */
+static void
+radio_audio_snap_publish(radio_t *radio)
+{
+	const rnav_set_t *set = radio_audio_set(radio);
+	unsigned gen = atomic_load_explicit(&radio->audio_gen,
+	    memory_order_relaxed);
+	audio_snap_t *snap = &radio->audio_snap[(gen + 1) & 1];
+
+	/*
+	 * Our previous generation bump must become visible before any of
+	 * the writes into the snapshot below.
+	 */
+	atomic_thread_fence(memory_order_release);
+
+	snap->failed = radio->failed;
+	snap->adf_mode = radio->adf_mode;
+	snap->num_navaids = 0;
+	for (size_t i = 0; i < set->num_navaids &&
+	    snap->num_navaids < MAX_AUDIO_NAVAIDS; i++) {
+		audio_navaid_t *anav;
+
+		if (set->signal_db[i] <= NOISE_FLOOR_AUDIO)
+			continue;
+		anav = &snap->navaids[snap->num_navaids++];
+		anav->signal_db = set->signal_db[i];
+		anav->audio_chunk_phase = set->audio_chunk_phase[i];
+		memcpy(anav->gate, set->cold[i].morse->gate,
+		    sizeof (anav->gate));
+	}
+
+	atomic_store_explicit(&radio->audio_gen, gen + 1,
+	    memory_order_release);
+}
+
+/*
+ * Reader side of the audio seqlock. Copies the latest published audio
+ * snapshot of the radio into `snap'.
+ */
+static void
+radio_audio_snap_read(radio_t *radio, audio_snap_t *snap)
+{
+	unsigned gen;
+
+	do {
+		const audio_snap_t *src;
+
+		gen = atomic_load_explicit(&radio->audio_gen,
+		    memory_order_acquire);
+		src = &radio->audio_snap[gen & 1];
+		snap->failed = src->failed;
+		snap->adf_mode = src->adf_mode;
+		/* guard against a torn read of num_navaids */
+		snap->num_navaids = MIN(src->num_navaids, MAX_AUDIO_NAVAIDS);
+		memcpy(snap->navaids, src->navaids,
+		    snap->num_navaids * sizeof (*snap->navaids));
+		atomic_thread_fence(memory_order_acquire);
+	} while (atomic_load_explicit(&radio->audio_gen,
+	    memory_order_relaxed) != gen);
+}
+
+static void
+radio_floop_cb(radio_t *radio, const pose_t *pose, double d_t)
+{
+	uint64_t new_freq;
+	wk_res_t *res;
+
+#if	USE_XPLANE_RADIO_DRS
+	switch (radio->type) {
+	case NAVRAD_TYPE_VLOC:
+		new_freq = dr_getf_prot(&radio->drs.vloc.freq) * 10000;
+		break;
+	case NAVRAD_TYPE_ADF:
 		new_freq = dr_getf_prot(&radio->drs.adf.freq) * 1000;
 		break;
 	default:
@@ -1242,8 +2149,6 @@ radio_floop_cb(radio_t *radio, double d_t)
 	new_freq = radio->new_freq;
 #endif	/* !USE_XPLANE_RADIO_DRS */
 
-	mutex_enter(&radio->lock);
-
 #if	USE_XPLANE_RADIO_DRS
 	radio->failed = (dr_geti(&radio->fail_dr[0]) == 6 ||
 	    dr_geti(&radio->fail_dr[1]) == 6);
@@ -1255,158 +2160,196 @@ radio_floop_cb(radio_t *radio, double d_t)
 		radio->freq = new_freq;
 		radio->freq_chg_t = navrad.cur_t;
 		radio->ident_delay = wavg(5, 10, crc64_rand_fract());
+		atomic_store_explicit(&radio->wk_freq, new_freq,
+		    memory_order_relaxed);
+	}
+
+	res = radio_wk_res_consume(radio);
+	if (res != NULL) {
+		radio_wk_res_merge(radio, res);
+		/*
+		 * Our candidates are covered by radio->db, so drop the
+		 * result's reference before the slot goes back to the
+		 * worker. Otherwise an idle radio's spare slots would keep
+		 * a swapped-out database alive.
+		 */
+		navrad_db_rele(res->db);
+		res->db = NULL;
 	}
 
 	switch (radio->type) {
 	case NAVRAD_TYPE_VLOC:
-		signal_levels_update(&radio->vlocs, d_t, &fpp, NULL);
-		signal_levels_update(&radio->gses, d_t, &fpp, NULL);
-		signal_levels_update(&radio->dmes, d_t, &fpp, &radio->vlocs);
+		signal_levels_update(&radio->vlocs, d_t, pose);
+		signal_levels_update(&radio->gses, d_t, pose);
+		signal_levels_update(&radio->dmes, d_t, pose);
 		break;
 	case NAVRAD_TYPE_ADF:
 		ASSERT3U(radio->type, ==, NAVRAD_TYPE_ADF);
-		signal_levels_update(&radio->adfs, d_t, &fpp, NULL);
+		signal_levels_update(&radio->adfs, d_t, pose);
 		break;
 	case NAVRAD_TYPE_DME:
-		signal_levels_update(&radio->vlocs, d_t, &fpp, NULL);
-		signal_levels_update(&radio->dmes, d_t, &fpp, &radio->vlocs);
+		signal_levels_update(&radio->vlocs, d_t, pose);
+		signal_levels_update(&radio->dmes, d_t, pose);
 		break;
 	}
 
-	mutex_exit(&radio->lock);
+	radio_audio_snap_publish(radio);
 }
 
-static void
-flush_navaid_tree(avl_tree_t *tree)
+static int
+wk_navaid_compar(const void *a, const void *b)
 {
-	void *cookie = NULL;
-	radio_navaid_t *rnav;
+	const wk_navaid_t *wa = a, *wb = b;
 
-	while ((rnav = avl_destroy_nodes(tree, &cookie)) != NULL)
-		free(rnav);
+	if ((uintptr_t)wa->navaid < (uintptr_t)wb->navaid)
+		return (-1);
+	if ((uintptr_t)wa->navaid > (uintptr_t)wb->navaid)
+		return (1);
+	return (0);
 }
 
 static void
-radio_refresh_navaid_list_type(radio_t *radio, avl_tree_t *tree,
-    geo_pos2_t pos, uint64_t freq, navaid_type_t type)
+wk_list_flush(wk_list_t *list)
 {
-	navaid_list_t *list;
+	list->num_navaids = 0;
+}
 
-	list = navaiddb_query(navrad.db, GEO3_TO_GEO2(pos), NAVAID_SRCH_RANGE,
-	    NULL, &freq, &type);
+static void
+wk_list_destroy(wk_list_t *list)
+{
+	free(list->navaids);
+	memset(list, 0, sizeof (*list));
+}
 
-	mutex_enter(&radio->lock);
+static bool_t
+wk_list_append(const navaid_t *nav, double dist, void *userinfo)
+{
+	wk_list_t *list = userinfo;
 
-	/* mark all navaids as outdated */
-	for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-	    rnav = AVL_NEXT(tree, rnav)) {
-		rnav->outdated = B_TRUE;
+	UNUSED(dist);
+	if (list->num_navaids == list->cap) {
+		list->cap = MAX(2 * list->cap, 16);
+		list->navaids = safe_realloc(list->navaids,
+		    list->cap * sizeof (*list->navaids));
 	}
-	/* process the list, adding new navaids & marking old ones */
-	for (size_t i = 0; i < list->num_navaids; i++) {
-		radio_navaid_t *rnav;
-		radio_navaid_t srch = { .navaid = list->navaids[i] };
-		avl_index_t where;
-
-		rnav = avl_find(tree, &srch, &where);
-		if (rnav == NULL) {
-			rnav = safe_calloc(1, sizeof (*rnav));
-			rnav->radio = radio;
-			rnav->navaid = list->navaids[i];
-			audio_buf_chunks_encode(rnav);
-			rnav->cur_audio_chunk[0] =
-			    crc64_rand() % AUDIO_BUF_NUM_CHUNKS;
-			for (int i = 1; i < NAVRAD_MAX_STREAMS; i++) {
-				rnav->cur_audio_chunk[i] =
-				    rnav->cur_audio_chunk[0];
-			}
-			rnav->signal_db = NOISE_FLOOR_TOO_FAR;
-			rnav->signal_db_omni = NOISE_FLOOR_TOO_FAR;
-			rnav->signal_db_tgt = NOISE_FLOOR_TOO_FAR;
-			avl_insert(tree, rnav, where);
-		} else {
-			rnav->outdated = B_FALSE;
-		}
+	list->navaids[list->num_navaids++] = (wk_navaid_t){
+	    .navaid = nav,
+	    .signal_db_tgt = NOISE_FLOOR_TOO_FAR,
+	    .propmode = ITM_PROPMODE_UNKNOWN,
+	    .terr_elev = NAN
+	};
+
+	return (B_TRUE);
+}
+
+static void
+radio_refresh_navaid_list_type(navaiddb_t *db, wk_list_t *list,
+    geo_pos3_t pos, uint64_t freq, navaid_type_t type)
+{
+	unsigned max_cands = atomic_load_explicit(&navrad.max_cands,
+	    memory_order_relaxed);
+	size_t n = 0;
+
+	/*
+	 * The query appends straight into the list, whose buffer lives
+	 * as long as the worker, so this doesn't allocate in steady state.
+	 */
+	list->num_navaids = 0;
+	if (max_cands == 0) {
+		navaiddb_query_foreach(db, GEO3_TO_GEO2(pos),
+		    NAVAID_SRCH_RANGE, NULL, &freq, &type, wk_list_append,
+		    list);
+	} else {
+		navaid_list_t *nl = &navrad.wk_nearest;
+
+		navaiddb_query_nearest(db, pos, NAVAID_SRCH_RANGE,
+		    max_cands, B_TRUE, NULL, &freq, &type, nl);
+		for (size_t i = 0; i < nl->num_navaids; i++)
+			wk_list_append(nl->navaids[i], nl->dists[i], list);
 	}
-	/* remove any navaids we haven't seen in the new list */
-	for (radio_navaid_t *rnav = avl_first(tree),
-	    *rnav_next = NULL; rnav != NULL; rnav = rnav_next) {
-		rnav_next = AVL_NEXT(tree, rnav);
-		if (rnav->outdated) {
-			avl_remove(tree, rnav);
-			free(rnav);
+	/*
+	 * The candidate merge in the flight loop needs the list sorted by
+	 * navaid pointer. Drop any duplicates while at it, so we never
+	 * compute the signal propagation for a navaid more than once.
+	 */
+	if (list->num_navaids != 0) {
+		qsort(list->navaids, list->num_navaids,
+		    sizeof (*list->navaids), wk_navaid_compar);
+		n = 1;
+		for (size_t i = 1; i < list->num_navaids; i++) {
+			if (list->navaids[i].navaid !=
+			    list->navaids[n - 1].navaid)
+				list->navaids[n++] = list->navaids[i];
 		}
 	}
+	list->num_navaids = n;
+}
 
-	mutex_exit(&radio->lock);
-
-	navaiddb_list_free(list);
+static bool_t
+radio_freq_is_valid(navrad_type_t type, uint64_t freq)
+{
+	switch (type) {
+	case NAVRAD_TYPE_ADF:
+		return (is_valid_ndb_freq(freq / 1000.0));
+	default:
+		return (is_valid_vor_freq(freq / 1000000.0) ||
+		    is_valid_loc_freq(freq / 1000000.0));
+	}
 }
 
 static void
-radio_refresh_navaid_list(radio_t *radio, geo_pos2_t pos, uint64_t freq)
+radio_refresh_navaid_list(radio_t *radio, wk_res_t *res, geo_pos3_t pos,
+    uint64_t freq)
 {
+	navaiddb_t *db = res->db->db;
+
+	wk_list_flush(&res->vlocs);
+	wk_list_flush(&res->gses);
+	wk_list_flush(&res->dmes);
+	wk_list_flush(&res->adfs);
+
 	switch (radio->type) {
 	case NAVRAD_TYPE_VLOC:
 		if (is_valid_vor_freq(freq / 1000000.0)) {
-			radio_refresh_navaid_list_type(radio, &radio->vlocs,
-			    pos, freq, NAVAID_VOR);
-			flush_navaid_tree(&radio->gses);
-			radio_refresh_navaid_list_type(radio, &radio->dmes,
-			    pos, freq, NAVAID_DME);
+			radio_refresh_navaid_list_type(db, &res->vlocs, pos,
+			    freq, NAVAID_VOR);
+			radio_refresh_navaid_list_type(db, &res->dmes, pos,
+			    freq, NAVAID_DME);
 		} else if (is_valid_loc_freq(freq / 1000000.0)) {
-			radio_refresh_navaid_list_type(radio, &radio->vlocs,
-			    pos, freq, NAVAID_LOC);
-			radio_refresh_navaid_list_type(radio, &radio->gses,
-			    pos, freq, NAVAID_GS);
-			radio_refresh_navaid_list_type(radio, &radio->dmes,
-			    pos, freq, NAVAID_DME);
-		} else {
-			mutex_enter(&radio->lock);
-			flush_navaid_tree(&radio->vlocs);
-			flush_navaid_tree(&radio->gses);
-			flush_navaid_tree(&radio->dmes);
-			mutex_exit(&radio->lock);
+			radio_refresh_navaid_list_type(db, &res->vlocs, pos,
+			    freq, NAVAID_LOC);
+			radio_refresh_navaid_list_type(db, &res->gses, pos,
+			    freq, NAVAID_GS);
+			radio_refresh_navaid_list_type(db, &res->dmes, pos,
+			    freq, NAVAID_DME);
 		}
 		break;
 	case NAVRAD_TYPE_ADF:
 		if (is_valid_ndb_freq(freq / 1000.0)) {
-			radio_refresh_navaid_list_type(radio, &radio->adfs,
-			    pos, freq, NAVAID_NDB);
-		} else {
-			mutex_enter(&radio->lock);
-			flush_navaid_tree(&radio->adfs);
-			mutex_exit(&radio->lock);
+			radio_refresh_navaid_list_type(db, &res->adfs, pos,
+			    freq, NAVAID_NDB);
 		}
 		break;
 	case NAVRAD_TYPE_DME:
 		if (is_valid_loc_freq(freq / 1000000.0)) {
-			radio_refresh_navaid_list_type(radio, &radio->vlocs,
-			    pos, freq, NAVAID_LOC);
-		} else {
-			mutex_enter(&radio->lock);
-			flush_navaid_tree(&radio->vlocs);
-			mutex_exit(&radio->lock);
+			radio_refresh_navaid_list_type(db, &res->vlocs, pos,
+			    freq, NAVAID_LOC);
 		}
 		if (is_valid_vor_freq(freq / 1000000.0) ||
 		    is_valid_loc_freq(freq / 1000000.0)) {
-			radio_refresh_navaid_list_type(radio, &radio->dmes,
-			    pos, freq, NAVAID_DME);
-		} else {
-			mutex_enter(&radio->lock);
-			flush_navaid_tree(&radio->dmes);
-			mutex_exit(&radio->lock);
+			radio_refresh_navaid_list_type(db, &res->dmes, pos,
+			    freq, NAVAID_DME);
 		}
 		break;
 	}
 }
 
 static bool_t
-profile_debug_check(radio_navaid_t *rnav)
+profile_debug_check(const radio_t *radio, const navaid_t *nav)
 {
-	return (rnav->radio->nr == profile_debug.nr &&
-	    rnav->navaid->type == profile_debug.type &&
-	    strcmp(rnav->navaid->id, profile_debug.id) == 0);
+	return (radio->nr == profile_debug.nr &&
+	    nav->type == profile_debug.type &&
+	    strcmp(nav->id, profile_debug.id) == 0);
 }
 
 static void
@@ -1538,7 +2481,7 @@ navaid_min_hgt(double dist)
 }
 
 typedef struct {
-	radio_navaid_t	*rnav;
+	const radio_t	*radio;
 	const navaid_t	*nav;
 	double		dist;
 } profile_debug_info_t;
@@ -1553,9 +2496,9 @@ profile_debug_cb(const egpws_terr_probe_t *probe, double p1_hgt, double p2_hgt,
 	ASSERT(userinfo != NULL);
 	info = userinfo;
 
-	ASSERT(info->rnav != NULL);
-	if (profile_debug_check(info->rnav)) {
-		ASSERT(info->nav != NULL);
+	ASSERT(info->radio != NULL);
+	ASSERT(info->nav != NULL);
+	if (profile_debug_check(info->radio, info->nav)) {
 
 		mutex_enter(&profile_debug.render_lock);
 		if (profile_debug.elev != NULL)
@@ -1576,17 +2519,17 @@ profile_debug_cb(const egpws_terr_probe_t *probe, double p1_hgt, double p2_hgt,
 }
 
 static void
-radio_navaid_recompute_signal(radio_navaid_t *rnav, uint64_t freq,
-    geo_pos3_t pos, const fpp_t *fpp)
+radio_navaid_recompute_signal(const radio_t *radio, wk_navaid_t *wnav,
+    uint64_t freq, geo_pos3_t pos, const fpp_t *fpp)
 {
-	const navaid_t *nav = rnav->navaid;
+	const navaid_t *nav = wnav->navaid;
 	double dist, nav_min_hgt, dbloss;
 	int propmode;
 	geo_pos3_t nav_pos;
 	itm_pol_t pol;
-	profile_debug_info_t info = { .rnav = rnav, .nav = nav };
+	profile_debug_info_t info = { .radio = radio, .nav = nav };
 
-	ASSERT(rnav != NULL);
+	ASSERT(nav != NULL);
 	ASSERT(fpp != NULL);
 
 	nav_pos = navaid_get_pos(nav);
@@ -1603,82 +2546,103 @@ radio_navaid_recompute_signal(radio_navaid_t *rnav, uint64_t freq,
 	libradio_compute_signal_prop(pos, nav_pos, 3, nav_min_hgt, freq, pol,
 	    &dbloss, &propmode, profile_debug_cb, &info);
 
-	rnav->signal_db_tgt = ANT_BASE_GAIN - dbloss;
-	rnav->propmode = propmode;
+	wnav->signal_db_tgt = ANT_BASE_GAIN - dbloss;
+	wnav->propmode = propmode;
 }
 
+/*
+ * Looks up the terrain elevation at all navaids in `list' in batches
+ * through the same terrain provider used for signal propagation.
+ */
 static void
-radio_dr_slot_populate(radio_t *radio, radio_navaid_t *rnav, unsigned nr)
+wk_list_probe_elev(wk_list_t *list)
 {
-	if (nr >= MAX_DR_VALS)
-		return;
+	enum { BATCH = 32 };
+	geo_pos2_t pts[BATCH];
+	double elev[BATCH], water[BATCH];
+
+	for (size_t i = 0; i < list->num_navaids; i += BATCH) {
+		egpws_terr_probe_t probe = {
+		    .num_pts = MIN(list->num_navaids - i, BATCH),
+		    .in_pts = pts, .out_elev = elev, .out_water = water
+		};
 
-	mutex_enter(&radio->lock);
-	strlcpy(radio->dr_vals[nr].id, rnav->navaid->id,
-	    sizeof (radio->dr_vals[nr].id));
-	radio->dr_vals[nr].type = rnav->navaid->type;
-	radio->dr_vals[nr].signal_db = rnav->signal_db;
-	radio->dr_vals[nr].propmode = rnav->propmode;
-	mutex_exit(&radio->lock);
+		for (size_t j = 0; j < probe.num_pts; j++) {
+			pts[j] = GEO3_TO_GEO2(navaid_get_pos(
+			    list->navaids[i + j].navaid));
+		}
+		navrad.opengpws->terr_probe(&probe);
+		for (size_t j = 0; j < probe.num_pts; j++)
+			list->navaids[i + j].terr_elev = elev[j];
+	}
 }
 
 static void
-radio_rnav_tree_worker(radio_t *radio, uint64_t freq, avl_tree_t *tree,
-    unsigned *dr_slot_p, geo_pos3_t pos, fpp_t *fpp)
+radio_wk_list_worker(const radio_t *radio, uint64_t freq, wk_list_t *list,
+    geo_pos3_t pos, fpp_t *fpp)
 {
-	for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-	    rnav = AVL_NEXT(tree, rnav)) {
-		radio_navaid_recompute_signal(rnav,
-		    navaid_act_freq(rnav->navaid->type, freq), pos, fpp);
-		radio_dr_slot_populate(radio, rnav, (*dr_slot_p)++);
+	for (size_t i = 0; i < list->num_navaids; i++) {
+		wk_navaid_t *wnav = &list->navaids[i];
+
+		radio_navaid_recompute_signal(radio, wnav,
+		    navaid_act_freq(wnav->navaid->type, freq), pos, fpp);
 	}
 }
 
+/*
+ * The worker never touches the radio's candidate sets. It builds a
+ * complete new set of candidates and their signal levels into its
+ * private back buffer and then hands that over to the flight loop.
+ */
 static void
-radio_worker(radio_t *radio, geo_pos3_t pos, fpp_t *fpp)
+radio_worker(radio_t *radio, navrad_db_t *dbh, geo_pos3_t pos, fpp_t *fpp)
 {
-	uint64_t freq;
-	unsigned dr_slot = 0;
-
-	mutex_enter(&radio->lock);
-	freq = radio->freq;
-	mutex_exit(&radio->lock);
-
-	radio_refresh_navaid_list(radio, GEO3_TO_GEO2(pos), freq);
+	uint64_t freq = atomic_load_explicit(&radio->wk_freq,
+	    memory_order_relaxed);
+	wk_res_t *res = &radio->wk_res[radio->wk_back];
 
 	/*
-	 * Don't have to grab the lock here, since we're the only ones that
-	 * can modify the trees and we're not going to be doing so here.
+	 * Untuned and failed radios cost us nothing beyond handing the
+	 * flight loop a single empty result to flush the old candidates.
 	 */
-	switch (radio->type) {
-	case NAVRAD_TYPE_VLOC:
-		radio_rnav_tree_worker(radio, freq, &radio->vlocs, &dr_slot,
-		    pos, fpp);
-		radio_rnav_tree_worker(radio, freq, &radio->gses, &dr_slot,
-		    pos, fpp);
-		radio_rnav_tree_worker(radio, freq, &radio->dmes, &dr_slot,
-		    pos, fpp);
-		break;
-	case NAVRAD_TYPE_ADF:
-		radio_rnav_tree_worker(radio, freq, &radio->adfs, &dr_slot,
-		    pos, fpp);
-		break;
-	case NAVRAD_TYPE_DME:
-		radio_rnav_tree_worker(radio, freq, &radio->vlocs, &dr_slot,
-		    pos, fpp);
-		radio_rnav_tree_worker(radio, freq, &radio->dmes, &dr_slot,
-		    pos, fpp);
-		break;
+	if (!radio_freq_is_valid(radio->type, freq)) {
+		/*
+		 * After a database swap, we still need to publish one
+		 * result, so the flight loop lets go of the old database.
+		 */
+		if (radio->wk_idle && radio->wk_db_gen == dbh->gen)
+			return;
+		radio->wk_idle = B_TRUE;
+	} else {
+		radio->wk_idle = B_FALSE;
+	}
+	radio->wk_db_gen = dbh->gen;
+
+	if (res->db != dbh) {
+		navrad_db_hold(dbh);
+		if (res->db != NULL)
+			navrad_db_rele(res->db);
+		res->db = dbh;
 	}
+	radio_refresh_navaid_list(radio, res, pos, freq);
 
-	mutex_enter(&radio->lock);
-	for (; dr_slot < MAX_DR_VALS; dr_slot++) {
-		radio->dr_vals[dr_slot].id[0] = '\0';
-		radio->dr_vals[dr_slot].type = 0;
-		radio->dr_vals[dr_slot].signal_db = 0;
-		radio->dr_vals[dr_slot].propmode = 0;
+	radio_wk_list_worker(radio, freq, &res->vlocs, pos, fpp);
+	radio_wk_list_worker(radio, freq, &res->gses, pos, fpp);
+	wk_list_probe_elev(&res->gses);
+	radio_wk_list_worker(radio, freq, &res->dmes, pos, fpp);
+	radio_wk_list_worker(radio, freq, &res->adfs, pos, fpp);
+
+	radio_wk_res_publish(radio);
+	/*
+	 * If the flight loop hadn't picked up our previous result, we get
+	 * it back unmerged, still holding its database. Drop that, as an
+	 * idle radio might not come back to this slot for a long time.
+	 */
+	res = &radio->wk_res[radio->wk_back];
+	if (res->db != NULL) {
+		navrad_db_rele(res->db);
+		res->db = NULL;
 	}
-	mutex_exit(&radio->lock);
 }
 
 static void
@@ -1799,13 +2763,47 @@ radio_update_rates(radio_t *radio, double d_t)
 	radio->gp_ddm_prev = radio->gp_ddm;
 }
 
-static float
-floop_cb(float elapsed1, float elapsed2, int counter, void *refcon)
+/*
+ * Captures a new aircraft pose snapshot. If the terrain probe fails, the
+ * previous height above ground is retained.
+ */
+static void
+pose_update(pose_t *pose)
 {
 	XPLMProbeInfo_t info = { .structSize = sizeof (info) };
-	XPLMProbeRef probe = XPLMCreateProbe(xplm_ProbeY);
+	XPLMProbeRef probe;
 	XPLMProbeResult res;
 	vect3_t pos3d;
+
+	pose->pos = GEO_POS3(dr_getf_prot(&drs.lat), dr_getf_prot(&drs.lon),
+	    dr_getf_prot(&drs.elev));
+	pose->ecef = geo2ecef_mtr(pose->pos, &wgs84);
+	enu_init(&pose->enu, pose->pos);
+	pose->hdgt = normalize_hdg(dr_getf_prot(&drs.hdg));
+	pose->pitch = dr_getf_prot(&drs.pitch);
+	pose->roll = dr_getf_prot(&drs.roll);
+	pose->magvar = dr_getf_prot(&drs.magvar);
+
+	probe = XPLMCreateProbe(xplm_ProbeY);
+	XPLMWorldToLocal(pose->pos.lat, pose->pos.lon, -1000,
+	    &pos3d.x, &pos3d.y, &pos3d.z);
+	res = XPLMProbeTerrainXYZ(probe, pos3d.x, pos3d.y, pos3d.z, &info);
+	if (res != xplm_ProbeHitTerrain) {
+		logMsg("XPLMProbeTerrainXYZ returned error: %d", res);
+	} else {
+		geo_pos3_t gnd_pos;
+
+		XPLMLocalToWorld(info.locationX, info.locationY, info.locationZ,
+		    &gnd_pos.lat, &gnd_pos.lon, &gnd_pos.elev);
+		pose->hgt_agl = pose->pos.elev - gnd_pos.elev;
+	}
+	XPLMDestroyProbe(probe);
+}
+
+static float
+floop_cb(float elapsed1, float elapsed2, int counter, void *refcon)
+{
+	const pose_t *pose = &navrad.pose;
 	double d_t;
 
 	UNUSED(elapsed1);
@@ -1824,60 +2822,52 @@ floop_cb(float elapsed1, float elapsed2, int counter, void *refcon)
 	if (d_t < MIN_DELTA_T)
 		goto out;
 
+	pose_update(&navrad.pose);
 	mutex_enter(&navrad.lock);
-	navrad.pos = GEO_POS3(dr_getf_prot(&drs.lat), dr_getf_prot(&drs.lon),
-	    dr_getf_prot(&drs.elev));
-	navrad.magvar = dr_getf_prot(&drs.magvar);
-	navrad.hdgt = normalize_hdg(dr_getf_prot(&drs.hdg));
+	navrad.pos = pose->pos;
 	mutex_exit(&navrad.lock);
 
-	XPLMWorldToLocal(navrad.pos.lat, navrad.pos.lon, -1000,
-	    &pos3d.x, &pos3d.y, &pos3d.z);
-	res = XPLMProbeTerrainXYZ(probe, pos3d.x, pos3d.y, pos3d.z, &info);
-	if (res != xplm_ProbeHitTerrain) {
-		logMsg("XPLMProbeTerrainXYZ returned error: %d", res);
-	} else {
-		geo_pos3_t gnd_pos;
-
-		XPLMDestroyProbe(probe);
-		XPLMLocalToWorld(info.locationX, info.locationY, info.locationZ,
-		    &gnd_pos.lat, &gnd_pos.lon, &gnd_pos.elev);
-		mutex_enter(&navrad.lock);
-		navrad.hgt_agl = navrad.pos.elev - gnd_pos.elev;
-		mutex_exit(&navrad.lock);
-	}
-
-	for (int i = 0; i < NUM_NAV_RADIOS; i++) {
-		radio_floop_cb(&navrad.vloc_radios[i], d_t);
-		radio_floop_cb(&navrad.adf_radios[i], d_t);
+	for (int type = 0; type < NUM_NAVRAD_TYPES; type++) {
+		for (unsigned i = 0; i < navrad.radios[type].num_radios; i++) {
+			radio_t *radio = navrad.radios[type].radios[i];
+			if (radio != NULL)
+				radio_floop_cb(radio, pose, d_t);
+		}
 	}
-	for (unsigned i = 0; i < navrad.num_dmes; i++)
-		radio_floop_cb(&navrad.dme_radio[i], d_t);
 
 #if	USE_XPLANE_RADIO_DRS
-	ap_drs_config(d_t);
+	ap_drs_config(pose, d_t);
 #endif
-	for (int i = 0; i < NUM_NAV_RADIOS; i++) {
-		/* VLOC radios */
-		radio_hdef_update(&navrad.vloc_radios[i], B_TRUE, d_t);
-		radio_hdef_update(&navrad.vloc_radios[i], B_FALSE, d_t);
-		radio_vdef_update(&navrad.vloc_radios[i], d_t);
-		radio_brg_update(&navrad.vloc_radios[i], d_t);
-		radio_dme_update(&navrad.vloc_radios[i], d_t);
+	for (int type = 0; type < NUM_NAVRAD_TYPES; type++) {
+		for (unsigned i = 0; i < navrad.radios[type].num_radios; i++) {
+			radio_t *radio = navrad.radios[type].radios[i];
+
+			if (radio == NULL)
+				continue;
+			switch (radio->type) {
+			case NAVRAD_TYPE_VLOC:
+				radio_hdef_update(radio, pose, B_TRUE, d_t);
+				radio_hdef_update(radio, pose, B_FALSE, d_t);
+				radio_vdef_update(radio, pose, d_t);
+				radio_brg_update(radio, pose, d_t);
+				radio_dme_update(radio, pose, d_t);
 #if	USE_XPLANE_RADIO_DRS
-		radio_update_rates(&navrad.vloc_radios[i], d_t);
-		ap_radio_drs_config(&navrad.vloc_radios[i], d_t);
+				radio_update_rates(radio, d_t);
 #endif
-		/* ADF radios */
-		radio_brg_update(&navrad.adf_radios[i], d_t);
+				break;
+			case NAVRAD_TYPE_ADF:
+				radio_brg_update(radio, pose, d_t);
+				break;
+			case NAVRAD_TYPE_DME:
+				radio_dme_update(radio, pose, d_t);
+				break;
+			}
 #if	USE_XPLANE_RADIO_DRS
-		ap_radio_drs_config(&navrad.adf_radios[i], d_t);
+			ap_radio_drs_config(radio, d_t);
 #endif
+		}
 	}
-	for (unsigned i = 0; i < navrad.num_dmes; i++)
-		radio_dme_update(&navrad.dme_radio[i], d_t);
 #if	USE_XPLANE_RADIO_DRS
-	ap_radio_drs_config(&navrad.dme_radio[0], d_t);
 	dr_seti(&drs.ovrd_dme, 1);
 	dr_seti(&drs.ovrd_adf, 1);
 #endif
@@ -1894,38 +2884,57 @@ worker_cb(void *userinfo)
 {
 	geo_pos3_t pos;
 	fpp_t fpp;
+	unsigned num_radios = 0;
+	navrad_db_t *dbh;
 
 	UNUSED(userinfo);
 
 	if (navrad.opengpws == NULL || !navrad.opengpws->is_inited())
 		return (B_TRUE);
 
+	/* stick to one database for the entire pass */
+	mutex_enter(&navrad.db_lock);
+	dbh = navrad.db;
+	navrad_db_hold(dbh);
+	mutex_exit(&navrad.db_lock);
+
 	mutex_enter(&navrad.lock);
 	pos = navrad.pos;
 	mutex_exit(&navrad.lock);
 
 	fpp = ortho_fpp_init(GEO3_TO_GEO2(pos), 0, &wgs84, B_TRUE);
 
-	for (int i = 0; i < NUM_NAV_RADIOS; i++) {
-		radio_worker(&navrad.vloc_radios[i], pos, &fpp);
-		radio_worker(&navrad.adf_radios[i], pos, &fpp);
-	}
-	for (unsigned i = 0; i < navrad.num_dmes; i++)
-		radio_worker(&navrad.dme_radio[i], pos, &fpp);
+	/*
+	 * Grab a reference to all registered radios, so we don't need to
+	 * hold the registry lock while working on them.
+	 */
+	mutex_enter(&navrad.radios_lock);
+	for (int type = 0; type < NUM_NAVRAD_TYPES; type++) {
+		for (unsigned i = 0; i < navrad.radios[type].num_radios; i++) {
+			radio_t *radio = navrad.radios[type].radios[i];
 
-	return (B_TRUE);
-}
+			if (radio == NULL)
+				continue;
+			if (num_radios == navrad.wk_radios_cap) {
+				navrad.wk_radios_cap = MAX(2 *
+				    navrad.wk_radios_cap, 8);
+				navrad.wk_radios = safe_realloc(
+				    navrad.wk_radios, navrad.wk_radios_cap *
+				    sizeof (*navrad.wk_radios));
+			}
+			radio_hold(radio);
+			navrad.wk_radios[num_radios++] = radio;
+		}
+	}
+	mutex_exit(&navrad.radios_lock);
 
-static int
-navrad_navaid_compar(const void *a, const void *b)
-{
-	const radio_navaid_t *rna = a, *rnb = b;
+	for (unsigned i = 0; i < num_radios; i++) {
+		radio_worker(navrad.wk_radios[i], dbh, pos, &fpp);
+		radio_rele(navrad.wk_radios[i]);
+	}
+	navrad_db_rele(dbh);
 
-	if (rna->navaid < rnb->navaid)
-		return (-1);
-	if (rna->navaid > rnb->navaid)
-		return (1);
-	return (0);
+	return (B_TRUE);
 }
 
 static const char *
@@ -1942,27 +2951,26 @@ navrad_type2str(navrad_type_t type)
 	}
 }
 
-static void
-radio_init(radio_t *radio, int nr, navrad_type_t type)
+static radio_t *
+radio_create(int nr, navrad_type_t type)
 {
+	radio_t *radio = safe_calloc(1, sizeof (*radio));
 	const char *name;
 
-	ASSERT(radio != NULL);
 	ASSERT3U(type, <=, NAVRAD_TYPE_DME);
 	name = navrad_type2str(type);
 
+	atomic_init(&radio->refcnt, 1);
 	radio->type = type;
 	radio->nr = nr;
 	radio->new_freq = FREQ_UNDEF;
-	mutex_init(&radio->lock);
-	avl_create(&radio->vlocs, navrad_navaid_compar,
-	    sizeof (radio_navaid_t), offsetof(radio_navaid_t, node));
-	avl_create(&radio->gses, navrad_navaid_compar,
-	    sizeof (radio_navaid_t), offsetof(radio_navaid_t, node));
-	avl_create(&radio->dmes, navrad_navaid_compar,
-	    sizeof (radio_navaid_t), offsetof(radio_navaid_t, node));
-	avl_create(&radio->adfs, navrad_navaid_compar,
-	    sizeof (radio_navaid_t), offsetof(radio_navaid_t, node));
+	radio->wk_back = 0;
+	atomic_init(&radio->wk_mid, 1);
+	radio->wk_front = 2;
+	rnav_set_init(&radio->vlocs, radio);
+	rnav_set_init(&radio->gses, radio);
+	rnav_set_init(&radio->dmes, radio);
+	rnav_set_init(&radio->adfs, radio);
 	for (unsigned i = 0; i < NAVRAD_MAX_STREAMS; i++) {
 		radio->distort_vloc[i] = distort_init(NAVRAD_AUDIO_SRATE);
 		radio->distort_dme[i] = distort_init(NAVRAD_AUDIO_SRATE);
@@ -2097,37 +3105,95 @@ radio_init(radio_t *radio, int nr, navrad_type_t type)
 		break;
 	}
 #endif	/* USE_XPLANE_RADIO_DRS */
+
+	return (radio);
 }
 
 static void
-destroy_rnav_tree(avl_tree_t *tree)
+radio_free(radio_t *radio)
 {
-	void *cookie = NULL;
-	radio_navaid_t *rnav;
+	ASSERT0(atomic_load(&radio->refcnt));
+
+	rnav_set_fini(&radio->vlocs);
+	rnav_set_fini(&radio->gses);
+	rnav_set_fini(&radio->dmes);
+	rnav_set_fini(&radio->adfs);
+	if (radio->db != NULL)
+		navrad_db_rele(radio->db);
+	for (int i = 0; i < 3; i++) {
+		if (radio->wk_res[i].db != NULL)
+			navrad_db_rele(radio->wk_res[i].db);
+		wk_list_destroy(&radio->wk_res[i].vlocs);
+		wk_list_destroy(&radio->wk_res[i].gses);
+		wk_list_destroy(&radio->wk_res[i].dmes);
+		wk_list_destroy(&radio->wk_res[i].adfs);
+	}
+	for (unsigned i = 0; i < NAVRAD_MAX_STREAMS; i++) {
+		if (radio->distort_vloc[i] != NULL)
+			distort_fini(radio->distort_vloc[i]);
+		if (radio->distort_dme[i] != NULL)
+			distort_fini(radio->distort_dme[i]);
+	}
+	free(radio);
+}
 
-	while ((rnav = avl_destroy_nodes(tree, &cookie)) != NULL)
-		free(rnav);
-	avl_destroy(tree);
+static void
+radio_hold(radio_t *radio)
+{
+	VERIFY3U(atomic_fetch_add(&radio->refcnt, 1), >, 0);
 }
 
 static void
-radio_fini(radio_t *radio)
+radio_rele(radio_t *radio)
 {
-	destroy_rnav_tree(&radio->vlocs);
-	destroy_rnav_tree(&radio->gses);
-	destroy_rnav_tree(&radio->dmes);
-	destroy_rnav_tree(&radio->adfs);
+	unsigned refcnt = atomic_fetch_sub(&radio->refcnt, 1);
 
-	for (unsigned i = 0; i < NAVRAD_MAX_STREAMS; i++) {
-		if (radio->distort_vloc[i] != NULL) {
-			distort_fini(radio->distort_vloc[i]);
-			radio->distort_vloc[i] = NULL;
-		}
-		if (radio->distort_dme[i] != NULL) {
-			distort_fini(radio->distort_dme[i]);
-			radio->distort_dme[i] = NULL;
-		}
+	VERIFY3U(refcnt, >, 0);
+	if (refcnt == 1)
+		radio_free(radio);
+}
+
+static navrad_db_t *
+navrad_db_alloc(navaiddb_t *db, bool_t owned)
+{
+	navrad_db_t *dbh = safe_calloc(1, sizeof (*dbh));
+
+	dbh->db = db;
+	dbh->owned = owned;
+	dbh->gen = ++navrad.db_gen;
+	atomic_init(&dbh->refcnt, 1);
+
+	return (dbh);
+}
+
+static void
+navrad_db_hold(navrad_db_t *dbh)
+{
+	VERIFY3U(atomic_fetch_add(&dbh->refcnt, 1), >, 0);
+}
+
+static void
+navrad_db_rele(navrad_db_t *dbh)
+{
+	unsigned refcnt = atomic_fetch_sub(&dbh->refcnt, 1);
+
+	VERIFY3U(refcnt, >, 0);
+	if (refcnt == 1) {
+		if (dbh->owned)
+			navaiddb_destroy(dbh->db);
+		free(dbh);
 	}
+}
+
+/*
+ * Tears down everything about a radio which must be done from the sim
+ * thread (i.e. dataref unregistration) and drops the registry's
+ * reference to it. The radio's memory might live on for a little while
+ * longer if the worker or an audio thread are still using it.
+ */
+static void
+radio_destroy(radio_t *radio)
+{
 	for (int i = 0; i < MAX_DR_VALS; i++) {
 		dr_delete(&radio->dr_vals[i].id_dr);
 		dr_delete(&radio->dr_vals[i].type_dr);
@@ -2153,51 +3219,74 @@ radio_fini(radio_t *radio)
 		dr_seti(&radio->drs.vloc.ovrd_nav_needles, 0);
 #endif	/* USE_XPLANE_RADIO_DRS */
 
-	mutex_destroy(&radio->lock);
+	radio_rele(radio);
 }
 
-static radio_navaid_t *
-radio_get_strongest_navaid(radio_t *radio, avl_tree_t *tree,
-    double recv_floor)
+/*
+ * Sim-thread-only radio lookup. Returns NULL if the radio doesn't exist.
+ */
+static radio_t *
+radio_lookup(navrad_type_t type, unsigned nr)
 {
-	radio_navaid_t *strongest = NULL, *second = NULL;
-	radio_navaid_t *winner = NULL;
+	ASSERT3U(type, <=, NAVRAD_TYPE_DME);
+	if (nr >= navrad.radios[type].num_radios)
+		return (NULL);
+	return (navrad.radios[type].radios[nr]);
+}
 
-	mutex_enter(&radio->lock);
+/*
+ * Radio lookup for use outside of the sim thread. If the radio exists,
+ * it is returned with an extra reference, which the caller must drop
+ * using radio_rele once done with it.
+ */
+static radio_t *
+radio_lookup_hold(navrad_type_t type, unsigned nr)
+{
+	radio_t *radio;
 
-	for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-	    rnav = AVL_NEXT(tree, rnav)) {
-		double signal_db = rnav->signal_db;
+	ASSERT3U(type, <=, NAVRAD_TYPE_DME);
+	mutex_enter(&navrad.radios_lock);
+	radio = radio_lookup(type, nr);
+	if (radio != NULL)
+		radio_hold(radio);
+	mutex_exit(&navrad.radios_lock);
 
-		if (signal_db < recv_floor)
-			continue;
-		if (strongest == NULL) {
-			strongest = rnav;
-		} else if (signal_db > strongest->signal_db) {
-			second = strongest;
-			strongest = rnav;
-		} else if (second == NULL || (second != NULL &&
-		    rnav->signal_db > second->signal_db)) {
-			second = rnav;
-		}
-	}
-	if (strongest != NULL)
-		ASSERT3P(strongest, !=, second);
+	return (radio);
+}
 
-	if (second != NULL &&
-	    strongest->signal_db - second->signal_db < INTERFERENCE_LIMIT) {
-		winner = NULL;
-	} else if (strongest != NULL) {
-		winner = strongest;
-	}
-	if (strongest != NULL)
-		radio->signal_db = strongest->signal_db;
-	else
+/*
+ * Locates the strongest navaid in `set' which is above `recv_floor' and
+ * not drowned out by a second station on the same frequency. Returns
+ * NULL if there is no such navaid, otherwise if `signal_db_p' is not
+ * NULL, it is filled with the signal level of the returned navaid.
+ * This only consults the selection cached by rnav_set_select, so it is
+ * cheap to call repeatedly during a tick.
+ */
+static const rnav_cold_t *
+radio_get_strongest_navaid(radio_t *radio, const rnav_set_t *set,
+    double recv_floor, double *signal_db_p)
+{
+	const double *signal_db = set->signal_db;
+	int strongest = set->strongest, second = set->second;
+
+	if (strongest != -1 && signal_db[strongest] < recv_floor)
+		strongest = -1;
+	if (second != -1 && signal_db[second] < recv_floor)
+		second = -1;
+	if (strongest == -1) {
 		radio->signal_db = NOISE_FLOOR_TOO_FAR;
+		return (NULL);
+	}
+	ASSERT3S(strongest, !=, second);
+	radio->signal_db = signal_db[strongest];
 
-	mutex_exit(&radio->lock);
+	if (second != -1 &&
+	    signal_db[strongest] - signal_db[second] < INTERFERENCE_LIMIT)
+		return (NULL);
+	if (signal_db_p != NULL)
+		*signal_db_p = signal_db[strongest];
 
-	return (winner);
+	return (&set->cold[strongest]);
 }
 
 #if	USE_XPLANE_RADIO_DRS
@@ -2218,67 +3307,47 @@ signal_error(double signal_db, double min_sigma)
 	return (crc64_rand_normal(MAX(1.0 / div, min_sigma)));
 }
 
+/*
+ * Returns the true bearing from the aircraft to a navaid candidate.
+ * Optionally also returns the horizontal distance to the navaid and its
+ * vertical angle above the aircraft's horizon.
+ */
 static double
-brg2navaid(const navaid_t *nav, double *dist, double *vert_angle)
-{
-	geo_pos3_t acf_pos;
-	geo_pos3_t nav_pos = navaid_get_pos(nav);
-	fpp_t fpp;
-	vect2_t v;
-
-	mutex_enter(&navrad.lock);
-	acf_pos = navrad.pos;
-	mutex_exit(&navrad.lock);
-
-	fpp = ortho_fpp_init(GEO3_TO_GEO2(acf_pos), 0, NULL, B_FALSE);
-	v = geo2fpp(GEO3_TO_GEO2(nav_pos), &fpp);
+brg2navaid(const pose_t *pose, const rnav_cold_t *rnav, double *dist,
+    double *vert_angle)
+{
+	vect3_t v = enu_project(&pose->enu, vect3_sub(rnav->ecef, pose->ecef));
+	double hdist = sqrt(POW2(v.x) + POW2(v.y));
 
 	if (dist != NULL)
-		*dist = vect2_abs(v);
+		*dist = hdist;
 	if (vert_angle != NULL) {
-		vect3_t acf_ecef = geo2ecef_mtr(acf_pos, &wgs84);
-		vect3_t nav_ecef = geo2ecef_mtr(nav_pos, &wgs84);
-		vect3_t acf2nav = vect3_sub(nav_ecef, acf_ecef);
-		vect3_t acf_uv = vect3_unit(acf_ecef, NULL);
-
-		if (!IS_ZERO_VECT3(acf2nav)) {
-			vect3_t acf2nav_uv = vect3_unit(acf2nav, NULL);
-			double cos_angle = vect3_dotprod(acf_uv, acf2nav_uv);
-			*vert_angle = 90 - RAD2DEG(acos(cos_angle));
-		} else {
+		if (!IS_ZERO_VECT3(v))
+			*vert_angle = RAD2DEG(atan2(v.z, hdist));
+		else
 			*vert_angle = 0;
-		}
 	}
 
-	return (dir2hdg(v));
+	return (dir2hdg(VECT2(v.x, v.y)));
 }
 
+/*
+ * Returns the true bearing from a navaid candidate to the aircraft, as
+ * seen at the navaid (i.e. the true radial we are on).
+ */
 static double
-brg_from_navaid(const navaid_t *nav, double *dist)
+brg_from_navaid(const pose_t *pose, const rnav_cold_t *rnav, double *dist)
 {
-	geo_pos3_t acf_pos;
-	geo_pos3_t nav_pos;
-	fpp_t fpp;
-	vect2_t v;
-
-	ASSERT(nav != NULL);
-	nav_pos = navaid_get_pos(nav);
-
-	mutex_enter(&navrad.lock);
-	acf_pos = navrad.pos;
-	mutex_exit(&navrad.lock);
-
-	fpp = ortho_fpp_init(GEO3_TO_GEO2(nav_pos), 0, NULL, B_FALSE);
-	v = geo2fpp(GEO3_TO_GEO2(acf_pos), &fpp);
+	vect3_t v = enu_project(&rnav->enu, vect3_sub(pose->ecef, rnav->ecef));
 
 	if (dist != NULL)
-		*dist = vect2_abs(v);
+		*dist = sqrt(POW2(v.x) + POW2(v.y));
 
-	return (dir2hdg(v));
+	return (dir2hdg(VECT2(v.x, v.y)));
 }
 
 static double
-brg_cone_error(radio_navaid_t *rnav)
+brg_cone_error(const rnav_cold_t *rnav)
 {
 	double f = clamp((rnav->slant_angle - 60) / 30, 0, 1);
 	double fact = POW3(f);
@@ -2296,32 +3365,32 @@ brg_cone_error(radio_navaid_t *rnav)
 }
 
 static double
-radio_get_bearing(radio_t *radio)
+radio_get_bearing(radio_t *radio, const pose_t *pose)
 {
-	double error, true_brg, vert_angle;
+	double error, true_brg, vert_angle, signal_db;
 	const navaid_t *nav;
-	radio_navaid_t *rnav;
+	const rnav_cold_t *rnav;
 
 	ASSERT(radio->type == NAVRAD_TYPE_VLOC ||
 	    radio->type == NAVRAD_TYPE_ADF);
 
 	if (radio->type == NAVRAD_TYPE_VLOC) {
 		rnav = radio_get_strongest_navaid(radio, &radio->vlocs,
-		    NOISE_FLOOR_AUDIO);
+		    NOISE_FLOOR_AUDIO, &signal_db);
 	} else {
 		rnav = radio_get_strongest_navaid(radio, &radio->adfs,
-		    NOISE_FLOOR_AUDIO);
+		    NOISE_FLOOR_AUDIO, &signal_db);
 	}
 	nav = (rnav != NULL ? rnav->navaid : NULL);
 
 	if (nav == NULL || nav->type == NAVAID_LOC ||
 	    ABS(navrad.cur_t - radio->freq_chg_t) < DME_CHG_DELAY)
 		return (NAN);
-	true_brg = brg2navaid(nav, NULL, &vert_angle);
+	true_brg = brg2navaid(pose, rnav, NULL, &vert_angle);
 
 	if (radio->type != NAVRAD_TYPE_ADF) {
 		enum { MAX_ERROR = 5 };
-		error = MAX_ERROR * signal_error(rnav->signal_db,
+		error = MAX_ERROR * signal_error(signal_db,
 		    VOR_SIGMA_FLOOR) + brg_cone_error(rnav);
 		return (normalize_hdg(true_brg + error));
 	} else {
@@ -2340,9 +3409,9 @@ radio_get_bearing(radio_t *radio)
 		enum { MAX_ERROR = 25 };
 
 		v = vect3_rot(v, -vert_angle, 0);
-		v = vect3_rot(v, true_brg - dr_getf_prot(&drs.hdg), 1);
-		v = vect3_rot(v, dr_getf_prot(&drs.pitch), 0);
-		v = vect3_rot(v, -dr_getf_prot(&drs.roll), 2);
+		v = vect3_rot(v, true_brg - pose->hdgt, 1);
+		v = vect3_rot(v, pose->pitch, 0);
+		v = vect3_rot(v, -pose->roll, 2);
 		v2 = VECT2(v.x, -v.z);
 
 		if (IS_ZERO_VECT2(v2))
@@ -2355,7 +3424,7 @@ radio_get_bearing(radio_t *radio)
 		 * remaining on-side component.
 		 */
 		signal_drop = log(vect2_abs(v2)) * 10;
-		error = MAX_ERROR * signal_error(rnav->signal_db + signal_drop,
+		error = MAX_ERROR * signal_error(signal_db + signal_drop,
 		    VOR_SIGMA_FLOOR) + brg_cone_error(rnav);
 
 		return (rel_brg + error);
@@ -2363,17 +3432,17 @@ radio_get_bearing(radio_t *radio)
 }
 
 static double
-radio_get_radial(radio_t *radio)
+radio_get_radial(radio_t *radio, const pose_t *pose)
 {
-	double radial, error;
-	radio_navaid_t *rnav;
+	double radial, error, signal_db;
+	const rnav_cold_t *rnav;
 	const navaid_t *nav;
 	enum { MAX_ERROR = 1 };
 
 	ASSERT3U(radio->type, ==, NAVRAD_TYPE_VLOC);
 
 	rnav = radio_get_strongest_navaid(radio, &radio->vlocs,
-	    NOISE_FLOOR_AUDIO);
+	    NOISE_FLOOR_AUDIO, &signal_db);
 	nav = (rnav != NULL ? rnav->navaid : NULL);
 	if (nav == NULL || nav->type == NAVAID_LOC ||
 	    nav->freq != radio->freq ||
@@ -2381,22 +3450,20 @@ radio_get_radial(radio_t *radio)
 		return (NAN);
 	}
 
-	radial = brg_from_navaid(nav, NULL);
-	error = MAX_ERROR * signal_error(rnav->signal_db, VOR_SIGMA_FLOOR) +
+	radial = brg_from_navaid(pose, rnav, NULL);
+	error = MAX_ERROR * signal_error(signal_db, VOR_SIGMA_FLOOR) +
 	    brg_cone_error(rnav);
 
 	return (normalize_hdg(radial + error - nav->vor.magvar));
 }
 
 static double
-radio_get_dme(radio_t *radio)
+radio_get_dme(radio_t *radio, const pose_t *pose)
 {
-	double dist, error;
-	radio_navaid_t *rnav = radio_get_strongest_navaid(radio, &radio->dmes,
-	    NOISE_FLOOR_AUDIO);
+	double dist, error, signal_db;
+	const rnav_cold_t *rnav = radio_get_strongest_navaid(radio,
+	    &radio->dmes, NOISE_FLOOR_AUDIO, &signal_db);
 	const navaid_t *nav = (rnav != NULL ? rnav->navaid : NULL);
-	vect3_t pos_3d;
-	geo_pos3_t pos;
 	/*
 	 * DME pulse width is set at 3.5 us (500 kHz bandwidth). Assuming
 	 * random noise moving this pulse around, we will simply assume
@@ -2412,20 +3479,15 @@ radio_get_dme(radio_t *radio)
 	    ABS(navrad.cur_t - radio->freq_chg_t) < DME_CHG_DELAY)
 		return (NAN);
 
-	mutex_enter(&navrad.lock);
-	pos = navrad.pos;
-	mutex_exit(&navrad.lock);
-
-	pos_3d = geo2ecef_mtr(pos, &wgs84);
-	dist = vect3_abs(vect3_sub(pos_3d, nav->ecef));
+	dist = vect3_abs(vect3_sub(pose->ecef, rnav->ecef));
 
-	error = MAX_ERROR * signal_error(rnav->signal_db, DME_SIGMA_FLOOR);
+	error = MAX_ERROR * signal_error(signal_db, DME_SIGMA_FLOOR);
 
 	return (MAX(dist + error + nav->dme.bias, 0));
 }
 
 static double
-radio_comp_hdef_loc(radio_t *radio, double *ddm_p)
+radio_comp_hdef_loc(radio_t *radio, const pose_t *pose, double *ddm_p)
 {
 	vect2_t distort_amplitude[] = {
 	    VECT2(0, 0),
@@ -2435,8 +3497,9 @@ radio_comp_hdef_loc(radio_t *radio, double *ddm_p)
 	    VECT2(90, 0.25),
 	    NULL_VECT2		/* list terminator */
 	};
-	radio_navaid_t *rnav = radio_get_strongest_navaid(radio, &radio->vlocs,
-	    NOISE_FLOOR_AUDIO);
+	double signal_db;
+	const rnav_cold_t *rnav = radio_get_strongest_navaid(radio,
+	    &radio->vlocs, NOISE_FLOOR_AUDIO, &signal_db);
 	const navaid_t *nav = (rnav != NULL ? rnav->navaid : NULL);
 	const double MAX_ERROR = 0.1;
 	double nav_brg, sig_err, angdev, ddm, sector_width_deg, seed;
@@ -2458,7 +3521,7 @@ radio_comp_hdef_loc(radio_t *radio, double *ddm_p)
 		return (NAN);
 	}
 	radio->loc_fcrs = nav->loc.brg;
-	nav_brg = normalize_hdg(brg_from_navaid(nav, NULL) + 180);
+	nav_brg = normalize_hdg(brg_from_navaid(pose, rnav, NULL) + 180);
 	angdev = rel_hdg(nav->loc.brg, nav_brg);
 
 	/* simulate reverse sensing for the back-course */
@@ -2489,7 +3552,7 @@ radio_comp_hdef_loc(radio_t *radio, double *ddm_p)
 	ASSERT(nav->loc.ref_datum_dist != 0);
 	sector_width_deg = RAD2DEG(atan(106.9 / nav->loc.ref_datum_dist));
 	distort_amplitude[1].x = sector_width_deg;
-	sig_err = MAX_ERROR * signal_error(rnav->signal_db, LOC_SIGMA_FLOOR);
+	sig_err = MAX_ERROR * signal_error(signal_db, LOC_SIGMA_FLOOR);
 	seed = crc64(nav->id, sizeof (nav->id)) & 255;
 	distort = (sin(0.87 * angdev + seed) + sin(angdev + seed) +
 	    sin(1.89 * angdev + seed)) *
@@ -2521,9 +3584,10 @@ radio_comp_hdef_loc(radio_t *radio, double *ddm_p)
 }
 
 static double
-radio_comp_hdef_vor(radio_t *radio, bool_t pilot, bool_t *tofrom_p)
+radio_comp_hdef_vor(radio_t *radio, const pose_t *pose, bool_t pilot,
+    bool_t *tofrom_p)
 {
-	double radial = radio_get_radial(radio);
+	double radial = radio_get_radial(radio, pose);
 	double crs, hdef;
 
 	ASSERT3U(radio->type, ==, NAVRAD_TYPE_VLOC);
@@ -2559,7 +3623,8 @@ radio_comp_hdef_vor(radio_t *radio, bool_t pilot, bool_t *tofrom_p)
 }
 
 static void
-radio_hdef_update(radio_t *radio, bool_t pilot, double d_t)
+radio_hdef_update(radio_t *radio, const pose_t *pose, bool_t pilot,
+    double d_t)
 {
 	double hdef;
 	bool_t tofrom = B_FALSE;
@@ -2567,12 +3632,12 @@ radio_hdef_update(radio_t *radio, bool_t pilot, double d_t)
 	ASSERT3U(radio->type, ==, NAVRAD_TYPE_VLOC);
 
 	if (is_valid_loc_freq(radio->freq / 1000000.0)) {
-		hdef = radio_comp_hdef_loc(radio, &radio->loc_ddm);
+		hdef = radio_comp_hdef_loc(radio, pose, &radio->loc_ddm);
 		tofrom = B_FALSE;
 		radio->state_drs.have_vor_sig = B_FALSE;
 		radio->radial = NAN;
 	} else {
-		hdef = radio_comp_hdef_vor(radio, pilot, &tofrom);
+		hdef = radio_comp_hdef_vor(radio, pose, pilot, &tofrom);
 		radio->loc_ddm = NAN;
 		radio->state_drs.have_loc_sig = B_FALSE;
 	}
@@ -2611,9 +3676,9 @@ radio_hdef_update(radio_t *radio, bool_t pilot, double d_t)
 }
 
 static void
-radio_vdef_update(radio_t *radio, double d_t)
+radio_vdef_update(radio_t *radio, const pose_t *pose, double d_t)
 {
-	radio_navaid_t *rnav;
+	const rnav_cold_t *rnav;
 	const navaid_t *nav;
 	double signal_db, offpath, brg, dist, long_dist, d_elev, angle;
 	double vdef_deg, vdef_dots, ddm_per_deg, error, angle_eff;
@@ -2632,10 +3697,10 @@ radio_vdef_update(radio_t *radio, double d_t)
 
 	ASSERT3U(radio->type, ==, NAVRAD_TYPE_VLOC);
 
+	signal_db = 0;
 	rnav = radio_get_strongest_navaid(radio, &radio->gses,
-	    NOISE_FLOOR_AUDIO);
+	    NOISE_FLOOR_AUDIO, &signal_db);
 	nav = (rnav != NULL ? rnav->navaid : NULL);
-	signal_db = (rnav != NULL ? rnav->signal_db : 0);
 	if (nav == NULL) {
 		radio->vdef = NAN;
 		radio->gp_ddm = NAN;
@@ -2650,30 +3715,32 @@ radio_vdef_update(radio_t *radio, double d_t)
 		radio->state_drs.have_gp_sig = B_FALSE;
 		return;
 	}
-	brg = normalize_hdg(brg_from_navaid(nav, &dist) + 180);
+	brg = normalize_hdg(brg_from_navaid(pose, rnav, &dist) + 180);
 	offpath = fabs(rel_hdg(brg, nav->gs.brg));
 	long_dist = dist * cos(DEG2RAD(offpath));
 	if (long_dist >= DB_ELEV_DIST) {
 		nav_elev = navaid_get_pos(nav).elev;
 	} else {
-		double xp_elev = navaiddb_get_xp_elev(nav);
+		double terr_elev = rnav->terr_elev;
 		/*
-		 * We use terrain probing to slowly phase in simulator scenery
+		 * We use terrain probing to slowly phase in terrain
 		 * elevation for navaids. This is because the navaid DB and
-		 * X-Plane's scenery often do not exactly match, so we can end
+		 * the terrain often do not exactly match, so we can end
 		 * up with glideslope signals not being aligned with the
-		 * vertical position of the runways they service.
+		 * vertical position of the runways they service. The
+		 * worker probes the terrain for us, so this never blocks.
 		 */
-		if (!isnan(xp_elev)) {
+		if (!isnan(terr_elev)) {
 			double f = iter_fract(long_dist, SCENERY_ELEV_DIST,
 			    DB_ELEV_DIST, B_TRUE);
 
-			nav_elev = wavg(xp_elev, navaid_get_pos(nav).elev, f);
+			nav_elev = wavg(terr_elev, navaid_get_pos(nav).elev,
+			    f);
 		} else {
 			nav_elev = navaid_get_pos(nav).elev;
 		}
 	}
-	d_elev = navrad.pos.elev - (nav_elev + GS_ANT_HEIGHT);
+	d_elev = pose->pos.elev - (nav_elev + GS_ANT_HEIGHT);
 	if (ABS(long_dist) > 0.1)
 		angle = RAD2DEG(atan(d_elev / long_dist));
 	else
@@ -2724,14 +3791,14 @@ radio_vdef_update(radio_t *radio, double d_t)
 }
 
 static void
-radio_brg_update(radio_t *radio, double d_t)
+radio_brg_update(radio_t *radio, const pose_t *pose, double d_t)
 {
 	double brg;
 
 	if (radio_adf_is_ant_mode(radio))
 		brg = NAVRAD_PARKED_BRG;
 	else
-		brg = radio_get_bearing(radio);
+		brg = radio_get_bearing(radio, pose);
 
 #if	USE_XPLANE_RADIO_DRS
 	radio->state_drs.have_ndb_sig = (radio->type == NAVRAD_TYPE_ADF &&
@@ -2746,7 +3813,7 @@ radio_brg_update(radio_t *radio, double d_t)
 		if (isnan(radio->brg))
 			radio->brg = NAVRAD_PARKED_BRG;
 		if (radio->type != NAVRAD_TYPE_ADF)
-			brg = normalize_hdg(brg - dr_getf_prot(&drs.hdg));
+			brg = normalize_hdg(brg - pose->hdgt);
 		else
 			brg = normalize_hdg(brg);
 		tgt = radio->brg + rel_hdg(radio->brg, brg);
@@ -2766,9 +3833,9 @@ radio_brg_update(radio_t *radio, double d_t)
 }
 
 static void
-radio_dme_update(radio_t *radio, double d_t)
+radio_dme_update(radio_t *radio, const pose_t *pose, double d_t)
 {
-	double dme = radio_get_dme(radio);
+	double dme = radio_get_dme(radio, pose);
 
 #if	USE_XPLANE_RADIO_DRS
 	if (!isnan(dme)) {
@@ -2851,6 +3918,8 @@ navrad_init2(navaiddb_t *db, unsigned num_dmes)
 	num_dmes = MAX(num_dmes, 1);
 #if	USE_XPLANE_RADIO_DRS
 	ASSERT3U(num_dmes, ==, 1);
+#else
+	ASSERT3U(num_dmes, <=, MAX_NUM_DMES);
 #endif
 
 	ASSERT(!inited);
@@ -2860,11 +3929,19 @@ navrad_init2(navaiddb_t *db, unsigned num_dmes)
 	memset(&profile_debug, 0, sizeof (profile_debug));
 	memset(&navaid_fail, 0, sizeof (navaid_fail));
 
-	navrad.db = db;
-	navrad.num_dmes = num_dmes;
+	mutex_init(&navrad.db_lock);
+	navrad.db = navrad_db_alloc(db, B_FALSE);
 	mutex_init(&navrad.lock);
+	mutex_init(&navrad.radios_lock);
 
 	mutex_init(&navaid_fail.lock);
+	htbl_create(&navaid_fail.by_id, 1024, NAVAID_FAIL_ID_LEN, B_TRUE);
+	htbl_create(&navrad.morse_pats, 1024, MORSE_MAX_CHARS + 1, B_FALSE);
+	list_create(&navaid_fail.direct, sizeof (navaid_fail_t),
+	    offsetof(navaid_fail_t, node));
+	/* cached failure states start out at generation 0, i.e. invalid */
+	atomic_init(&navaid_fail.gen, 1);
+	atomic_init(&navrad.max_cands, MAX_CANDS_DFL);
 
 	fdr_find(&drs.lat, "sim/flightmodel/position/latitude");
 	fdr_find(&drs.lon, "sim/flightmodel/position/longitude");
@@ -2893,12 +3970,12 @@ navrad_init2(navaiddb_t *db, unsigned num_dmes)
 #endif	/* LIBRADIO_APCTL */
 #endif	/* USE_XPLANE_RADIO_DRS */
 
-	for (int i = 0; i < NUM_NAV_RADIOS; i++) {
-		radio_init(&navrad.vloc_radios[i], i + 1, NAVRAD_TYPE_VLOC);
-		radio_init(&navrad.adf_radios[i], i + 1, NAVRAD_TYPE_ADF);
+	for (unsigned i = 0; i < NUM_NAV_RADIOS; i++) {
+		VERIFY(navrad_add_radio(NAVRAD_TYPE_VLOC, i));
+		VERIFY(navrad_add_radio(NAVRAD_TYPE_ADF, i));
 	}
-	for (unsigned i = 0; i < navrad.num_dmes; i++)
-		radio_init(&navrad.dme_radio[i], i + 1, NAVRAD_TYPE_DME);
+	for (unsigned i = 0; i < num_dmes; i++)
+		VERIFY(navrad_add_radio(NAVRAD_TYPE_DME, i));
 
 	XPLMRegisterFlightLoopCallback(floop_cb, FLOOP_INTVAL, NULL);
 
@@ -2921,8 +3998,15 @@ navrad_init2(navaiddb_t *db, unsigned num_dmes)
 void
 navrad_fini(void)
 {
+	navaid_fail_t *fail;
+
 	if (!inited)
 		return;
+	/* a reload in progress still needs to hand over its database */
+	if (navrad.reload.started)
+		thread_join(&navrad.reload.thr);
+	free(navrad.reload.xpdir);
+	free(navrad.reload.cachedir);
 	inited = B_FALSE;
 
 	/*
@@ -2944,12 +4028,20 @@ navrad_fini(void)
 	mutex_destroy(&profile_debug.render_lock);
 	mutex_destroy(&profile_debug.lock);
 
-	for (int i = 0; i < NUM_NAV_RADIOS; i++) {
-		radio_fini(&navrad.vloc_radios[i]);
-		radio_fini(&navrad.adf_radios[i]);
+	for (int type = 0; type < NUM_NAVRAD_TYPES; type++) {
+		for (unsigned i = 0; i < navrad.radios[type].num_radios; i++) {
+			if (navrad.radios[type].radios[i] != NULL)
+				radio_destroy(navrad.radios[type].radios[i]);
+		}
+		free(navrad.radios[type].radios);
 	}
-	for (unsigned i = 0; i < navrad.num_dmes; i++)
-		radio_fini(&navrad.dme_radio[i]);
+	free(navrad.wk_radios);
+	navaiddb_list_fini(&navrad.wk_nearest);
+	htbl_empty(&navrad.morse_pats, morse_pat_free, NULL);
+	htbl_destroy(&navrad.morse_pats);
+	/* the radios are gone, so this was the last reference */
+	navrad_db_rele(navrad.db);
+	mutex_destroy(&navrad.db_lock);
 
 #if	USE_XPLANE_RADIO_DRS
 	dr_seti(&drs.ovrd_dme, 0);
@@ -2961,7 +4053,19 @@ navrad_fini(void)
 #endif	/* USE_XPLANE_RADIO_DRS */
 
 	mutex_destroy(&navrad.lock);
+	mutex_destroy(&navrad.radios_lock);
 	XPLMUnregisterFlightLoopCallback(floop_cb, NULL);
+
+	htbl_empty(&navaid_fail.by_id, NULL, NULL);
+	htbl_destroy(&navaid_fail.by_id);
+	while ((fail = list_remove_head(&navaid_fail.direct)) != NULL)
+		free(fail);
+	list_destroy(&navaid_fail.direct);
+	for (unsigned i = 0; i < navaid_fail.num_slots; i++)
+		free(navaid_fail.slots[i]);
+	free(navaid_fail.slots);
+	navaid_fail.slots = NULL;
+	navaid_fail.num_slots = 0;
 	mutex_destroy(&navaid_fail.lock);
 }
 
@@ -2984,15 +4088,177 @@ navrad_worker_stop(void)
 static radio_t *
 find_radio(navrad_type_t type, unsigned nr)
 {
+	radio_t *radio = radio_lookup(type, nr);
+	ASSERT_MSG(radio != NULL, "%s%d radio doesn't exist",
+	    navrad_type2str(type), nr + 1);
+	return (radio);
+}
+
+bool_t
+navrad_add_radio(navrad_type_t type, unsigned nr)
+{
+	radio_t *radio;
+
+	ASSERT(inited);
 	ASSERT3U(type, <=, NAVRAD_TYPE_DME);
-	if (type == NAVRAD_TYPE_DME) {
-		ASSERT3U(nr, <, navrad.num_dmes);
-		return (&navrad.dme_radio[nr]);
-	} else {
-		ASSERT3U(nr, <, NUM_NAV_RADIOS);
-		return (type == NAVRAD_TYPE_VLOC ? &navrad.vloc_radios[nr] :
-		    &navrad.adf_radios[nr]);
+
+	if (nr >= NAVRAD_MAX_RADIOS) {
+		logMsg("Cannot add radio %s%u: at most %d radios of each "
+		    "type are supported", navrad_type2str(type), nr + 1,
+		    NAVRAD_MAX_RADIOS);
+		return (B_FALSE);
+	}
+	if (radio_lookup(type, nr) != NULL)
+		return (B_FALSE);
+#if	USE_XPLANE_RADIO_DRS
+	/*
+	 * Our radios follow X-Plane's own radios, so we can't have any
+	 * radios which X-Plane itself doesn't have.
+	 */
+	if (nr >= (type == NAVRAD_TYPE_DME ? 1 : NUM_NAV_RADIOS)) {
+		logMsg("Cannot add radio %s%d: not supported with "
+		    "USE_XPLANE_RADIO_DRS=%d", navrad_type2str(type), nr + 1,
+		    USE_XPLANE_RADIO_DRS);
+		return (B_FALSE);
+	}
+#endif	/* USE_XPLANE_RADIO_DRS */
+	radio = radio_create(nr + 1, type);
+
+	mutex_enter(&navrad.radios_lock);
+	if (nr >= navrad.radios[type].num_radios) {
+		navrad.radios[type].radios = safe_realloc(
+		    navrad.radios[type].radios,
+		    (nr + 1) * sizeof (*navrad.radios[type].radios));
+		for (unsigned i = navrad.radios[type].num_radios; i < nr; i++)
+			navrad.radios[type].radios[i] = NULL;
+		navrad.radios[type].num_radios = nr + 1;
+	}
+	navrad.radios[type].radios[nr] = radio;
+	mutex_exit(&navrad.radios_lock);
+
+	return (B_TRUE);
+}
+
+void
+navrad_remove_radio(navrad_type_t type, unsigned nr)
+{
+	radio_t *radio;
+
+	ASSERT(inited);
+	radio = radio_lookup(type, nr);
+	if (radio == NULL)
+		return;
+
+	mutex_enter(&navrad.radios_lock);
+	navrad.radios[type].radios[nr] = NULL;
+	while (navrad.radios[type].num_radios != 0 &&
+	    navrad.radios[type].radios[
+	    navrad.radios[type].num_radios - 1] == NULL) {
+		navrad.radios[type].num_radios--;
+	}
+	mutex_exit(&navrad.radios_lock);
+
+	radio_destroy(radio);
+}
+
+bool_t
+navrad_have_radio(navrad_type_t type, unsigned nr)
+{
+	ASSERT(inited);
+	return (radio_lookup(type, nr) != NULL);
+}
+
+unsigned
+navrad_get_num_radios(navrad_type_t type)
+{
+	ASSERT(inited);
+	ASSERT3U(type, <=, NAVRAD_TYPE_DME);
+	return (navrad.radios[type].num_radios);
+}
+
+void
+navrad_set_max_candidates(unsigned n)
+{
+	ASSERT(inited);
+	atomic_store_explicit(&navrad.max_cands, n, memory_order_relaxed);
+}
+
+unsigned
+navrad_get_max_candidates(void)
+{
+	ASSERT(inited);
+	return (atomic_load_explicit(&navrad.max_cands, memory_order_relaxed));
+}
+
+/*
+ * Replaces the navaid database. The radios switch over as soon as the
+ * worker has looked up their candidates in the new database, without
+ * ever stopping to receive. libradio takes ownership of `db' and
+ * destroys it once it has been replaced and no radio is using it
+ * anymore. This may be called from any thread.
+ */
+void
+navrad_set_db(navaiddb_t *db)
+{
+	navrad_db_t *old;
+
+	ASSERT(inited);
+	ASSERT(db != NULL);
+
+	mutex_enter(&navrad.db_lock);
+	old = navrad.db;
+	navrad.db = navrad_db_alloc(db, B_TRUE);
+	mutex_exit(&navrad.db_lock);
+
+	navrad_db_rele(old);
+}
+
+static void
+reload_thr_proc(void *unused)
+{
+	navaiddb_t *db;
+
+	UNUSED(unused);
+
+	db = navaiddb_create2(navrad.reload.xpdir, navrad.reload.cachedir,
+	    navrad.reload.adb);
+	if (db != NULL)
+		navrad_set_db(db);
+	else
+		logMsg("navaid database reload failed, keeping the old one");
+	atomic_store(&navrad.reload.done, B_TRUE);
+}
+
+/*
+ * Rebuilds the navaid database (e.g. after an AIRAC update) on a
+ * background thread, using the same arguments as navaiddb_create2, and
+ * then switches to it using navrad_set_db. Returns B_FALSE if a previous
+ * reload is still in progress.
+ */
+bool_t
+navrad_reload_db(const char *xpdir, const char *cachedir, airportdb_t *adb)
+{
+	ASSERT(inited);
+	ASSERT(xpdir != NULL);
+	ASSERT(adb != NULL);
+
+	if (navrad.reload.started) {
+		if (!atomic_load(&navrad.reload.done))
+			return (B_FALSE);
+		thread_join(&navrad.reload.thr);
+		navrad.reload.started = B_FALSE;
 	}
+	free(navrad.reload.xpdir);
+	free(navrad.reload.cachedir);
+	navrad.reload.xpdir = safe_strdup(xpdir);
+	navrad.reload.cachedir = (cachedir != NULL ? safe_strdup(cachedir) :
+	    NULL);
+	navrad.reload.adb = adb;
+	atomic_store(&navrad.reload.done, B_FALSE);
+	VERIFY(thread_create(&navrad.reload.thr, reload_thr_proc, NULL));
+	navrad.reload.started = B_TRUE;
+
+	return (B_TRUE);
 }
 
 void
@@ -3066,8 +4332,7 @@ navrad_set_obs(unsigned nr, double obs)
 	    "with USE_XPLANE_RADIO_DRS=%d", USE_XPLANE_RADIO_DRS);
 #else	/* !USE_XPLANE_RADIO_DRS */
 	ASSERT(inited);
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
-	navrad.vloc_radios[nr].obs = obs;
+	find_radio(NAVRAD_TYPE_VLOC, nr)->obs = obs;
 #endif	/* !USE_XPLANE_RADIO_DRS */
 }
 
@@ -3083,10 +4348,9 @@ double
 navrad_get_radial(unsigned nr)
 {
 	radio_t *radio = find_radio(NAVRAD_TYPE_VLOC, nr);
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
 	if (!radio_operable(radio))
 		return (NAN);
-	return (radio_get_radial(radio));
+	return (radio_get_radial(radio, &navrad.pose));
 }
 
 double
@@ -3103,62 +4367,62 @@ navrad_get_dme(navrad_type_t type, unsigned nr)
 double
 navrad_get_hdef(unsigned nr, bool_t pilot, bool_t *tofrom)
 {
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
-	if (navrad.vloc_radios[nr].failed)
+	radio_t *radio = find_radio(NAVRAD_TYPE_VLOC, nr);
+	if (radio->failed)
 		return (NAN);
-	return (radio_get_hdef(&navrad.vloc_radios[nr], pilot, tofrom));
+	return (radio_get_hdef(radio, pilot, tofrom));
 }
 
 double
 navrad_get_loc_ddm(unsigned nr)
 {
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
-	if (navrad.vloc_radios[nr].failed)
+	radio_t *radio = find_radio(NAVRAD_TYPE_VLOC, nr);
+	if (radio->failed)
 		return (NAN);
-	return (navrad.vloc_radios[nr].loc_ddm);
+	return (radio->loc_ddm);
 }
 
 double
 navrad_get_vdef(unsigned nr)
 {
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
-	if (navrad.vloc_radios[nr].failed)
+	radio_t *radio = find_radio(NAVRAD_TYPE_VLOC, nr);
+	if (radio->failed)
 		return (NAN);
-	return (navrad.vloc_radios[nr].vdef);
+	return (radio->vdef);
 }
 
 double
 navrad_get_gp_ddm(unsigned nr)
 {
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
-	if (navrad.vloc_radios[nr].failed)
+	radio_t *radio = find_radio(NAVRAD_TYPE_VLOC, nr);
+	if (radio->failed)
 		return (NAN);
-	return (navrad.vloc_radios[nr].gp_ddm);
+	return (radio->gp_ddm);
 }
 
 double
 navrad_get_fcrs(unsigned nr)
 {
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
-	if (navrad.vloc_radios[nr].failed)
+	radio_t *radio = find_radio(NAVRAD_TYPE_VLOC, nr);
+	if (radio->failed)
 		return (NAN);
-	return (navrad.vloc_radios[nr].loc_fcrs);
+	return (radio->loc_fcrs);
 }
 
 double
 navrad_get_gs(unsigned nr)
 {
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
-	if (navrad.vloc_radios[nr].failed)
+	radio_t *radio = find_radio(NAVRAD_TYPE_VLOC, nr);
+	if (radio->failed)
 		return (NAN);
-	return (navrad.vloc_radios[nr].gs);
+	return (radio->gs);
 }
 
 bool_t 
 navrad_is_loc(unsigned nr)
 {
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
-	return (is_valid_loc_freq(navrad.vloc_radios[nr].freq / 1000000.0));
+	radio_t *radio = find_radio(NAVRAD_TYPE_VLOC, nr);
+	return (is_valid_loc_freq(radio->freq / 1000000.0));
 }
 
 void
@@ -3180,7 +4444,7 @@ navrad_get_ID(navrad_type_t type, unsigned nr, char id[8])
 {
 	radio_t *radio = find_radio(type, nr);
 	const navaid_t *nav;
-	radio_navaid_t *rnav;
+	const rnav_cold_t *rnav;
 
 	if (radio->failed)
 		return (B_FALSE);
@@ -3190,28 +4454,24 @@ navrad_get_ID(navrad_type_t type, unsigned nr, char id[8])
 	if (navrad.cur_t < radio->freq_chg_t + radio->ident_delay)
 		return (B_FALSE);
 
-	mutex_enter(&radio->lock);
 	switch (radio->type) {
 	case NAVRAD_TYPE_VLOC:
 		rnav = radio_get_strongest_navaid(radio, &radio->vlocs,
-		    NOISE_FLOOR_TEST);
+		    NOISE_FLOOR_TEST, NULL);
 		break;
 	case NAVRAD_TYPE_ADF:
 		rnav = radio_get_strongest_navaid(radio, &radio->adfs,
-		    NOISE_FLOOR_TEST);
+		    NOISE_FLOOR_TEST, NULL);
 		break;
 	default:
 		ASSERT3U(radio->type, ==, NAVRAD_TYPE_DME);
 		rnav = radio_get_strongest_navaid(radio, &radio->dmes,
-		    NOISE_FLOOR_TEST);
+		    NOISE_FLOOR_TEST, NULL);
 		break;
 	}
-	if (rnav == NULL) {
-		mutex_exit(&radio->lock);
+	if (rnav == NULL)
 		return (B_FALSE);
-	}
 	nav = rnav->navaid;
-	mutex_exit(&radio->lock);
 
 	strlcpy(id, nav->id, 8);
 	return (B_TRUE);
@@ -3224,96 +4484,142 @@ navrad_have_bearing(navrad_type_t type, unsigned nr)
 	return (!isnan(radio->brg));
 }
 
+static inline bool_t
+audio_navaid_tone_on(const audio_navaid_t *anav, unsigned chunk_ctr)
+{
+	unsigned chunk = (anav->audio_chunk_phase + chunk_ctr) %
+	    AUDIO_BUF_NUM_CHUNKS;
+
+	return ((anav->gate[chunk / 64] >> (chunk % 64)) & 1);
+}
+
+/*
+ * Writes `gain' times the periodic waveform `tone' of `step' samples
+ * into `buf', saturating at the int16_t limits. An audio buffer always
+ * spans exactly one morse chunk, so every tone period in it is keyed
+ * identically. We thus only compute the first period and then replicate
+ * it, doubling the copied span each time.
+ */
+static void
+tone_render(int16_t *buf, size_t num_samples, const int16_t *tone,
+    size_t step, float gain)
+{
+	ASSERT(buf != NULL);
+	ASSERT(tone != NULL);
+	ASSERT3U(num_samples, >=, step);
+	ASSERT0(num_samples % step);
+
+	for (size_t j = 0; j < step; j++) {
+		float v = tone[j] * gain;
+
+		v = (v > INT16_MAX ? INT16_MAX : v);
+		v = (v < INT16_MIN ? INT16_MIN : v);
+		buf[j] = v;
+	}
+	for (size_t n = step; n < num_samples;) {
+		size_t len = MIN(n, num_samples - n);
+
+		memcpy(&buf[n], buf, len * sizeof (*buf));
+		n += len;
+	}
+}
+
 static void
-bfo_tones_generate(avl_tree_t *tree, int16_t *buf, size_t step,
+bfo_tones_generate(const audio_snap_t *snap, int16_t *buf, size_t step,
     size_t num_samples, double noise_level_db, double tone_db,
-    unsigned stream_id, const int16_t *tone)
+    unsigned chunk_ctr, const int16_t *tone)
 {
 	enum { NOISE_FLOOR_TONE = -100 };
 	double noise_span = (noise_level_db - 20) - NOISE_FLOOR_TONE;
 	double tone_span = tone_db - NOISE_FLOOR_TONE;
 	double level = clamp(1 / (tone_span / noise_span), 0, 1);
 
-	ASSERT(tree != NULL);
+	ASSERT(snap != NULL);
 	ASSERT(buf != NULL);
 	ASSERT(tone != NULL);
-	ASSERT3U(stream_id, <, NAVRAD_MAX_STREAMS);
 
-	for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-	    rnav = AVL_NEXT(tree, rnav)) {
-		if (rnav->signal_db <= NOISE_FLOOR_AUDIO)
-			continue;
-		if (rnav->audio_chunks[rnav->cur_audio_chunk[stream_id]] != 0) {
+	for (unsigned i = 0; i < snap->num_navaids; i++) {
+		if (audio_navaid_tone_on(&snap->navaids[i], chunk_ctr)) {
 			level = 1;
 			break;
 		}
 	}
 
-	for (size_t i = 0; i < num_samples; i += step) {
-		for (size_t j = 0; j < step; j++)
-			buf[i + j] += tone[j] * POW4(level) * POW2(level);
-	}
+	tone_render(buf, num_samples, tone, step, POW4(level) * POW2(level));
 }
 
+/*
+ * All keyed navaids transmit the same tone in phase, so their mix is
+ * simply the tone scaled by the sum of their gains.
+ */
 static void
-am_tones_generate(avl_tree_t *tree, int16_t *buf, size_t step,
-    size_t num_samples, double span, unsigned stream_id, const int16_t *tone)
+am_tones_generate(const audio_snap_t *snap, int16_t *buf, size_t step,
+    size_t num_samples, double span, unsigned chunk_ctr, const int16_t *tone)
 {
-	ASSERT(tree != NULL);
+	double gain = 0;
+
+	ASSERT(snap != NULL);
 	ASSERT(buf != NULL);
 	ASSERT(tone != NULL);
-	ASSERT3U(stream_id, <, NAVRAD_MAX_STREAMS);
 
-	for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-	    rnav = AVL_NEXT(tree, rnav)) {
+	for (unsigned k = 0; k < snap->num_navaids; k++) {
+		const audio_navaid_t *anav = &snap->navaids[k];
 		double level;
 
-		if (rnav->signal_db <= NOISE_FLOOR_AUDIO ||
-		    rnav->audio_chunks[rnav->cur_audio_chunk[stream_id]] == 0)
+		if (!audio_navaid_tone_on(anav, chunk_ctr))
 			continue;
 
-		level = (rnav->signal_db - NOISE_FLOOR_AUDIO) / span;
-		for (size_t i = 0; i < num_samples; i += step) {
-			for (size_t j = 0; j < step; j++)
-				buf[i + j] += tone[j] * POW3(level);
-		}
+		level = (anav->signal_db - NOISE_FLOOR_AUDIO) / span;
+		gain += POW3(level);
 	}
+	if (gain != 0)
+		tone_render(buf, num_samples, tone, step, gain);
 }
 
-static int16_t *
-get_audio_buf_type(radio_t *radio, avl_tree_t *tree, double volume,
-    const int16_t *tone, size_t step, size_t num_samples, bool_t squelch,
-    bool_t agc, distort_t *distort_ctx, unsigned stream_id)
+/*
+ * Renders one audio chunk for the radio into `buf'. This runs on the
+ * caller's audio thread, never takes any radio locks and doesn't
+ * allocate any memory. All radio and navaid state is taken from `snap',
+ * the caller's private copy of the latest audio snapshot published by
+ * the flight loop, while the chunk position is tracked per stream, so
+ * that multiple audio streams can render the same radio concurrently.
+ */
+static void
+render_audio_type(radio_t *radio, const audio_snap_t *snap, double volume,
+    const int16_t *tone, size_t step, int16_t *buf, size_t num_samples,
+    bool_t squelch, bool_t agc, distort_t *distort_ctx, unsigned stream_id)
 {
-	int16_t *buf = safe_calloc(num_samples, sizeof (*buf));
 	double max_db = NOISE_LEVEL_AUDIO;
 	double tone_db = NOISE_FLOOR_NAV_ID;
 	double max_signal_db = NOISE_FLOOR_AUDIO;
 	double span, noise_level, noise_level_db;
+	unsigned chunk_ctr;
 
 	ASSERT(radio != NULL);
-	ASSERT(tree != NULL);
+	ASSERT(snap != NULL);
 	ASSERT(tone != NULL);
+	ASSERT(buf != NULL);
 	ASSERT(distort_ctx != NULL);
 	ASSERT3U(stream_id, <, NAVRAD_MAX_STREAMS);
 
-	mutex_enter(&radio->lock);
+	memset(buf, 0, num_samples * sizeof (*buf));
+	chunk_ctr = atomic_load_explicit(&radio->audio_chunk_ctr[stream_id],
+	    memory_order_relaxed);
+	atomic_store_explicit(&radio->audio_chunk_ctr[stream_id],
+	    (chunk_ctr + 1) % AUDIO_BUF_NUM_CHUNKS, memory_order_relaxed);
 
 	if (agc) {
-		for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-		    rnav = AVL_NEXT(tree, rnav)) {
-			if (rnav->signal_db <= NOISE_FLOOR_AUDIO)
-				continue;
+		for (unsigned i = 0; i < snap->num_navaids; i++) {
+			const audio_navaid_t *anav = &snap->navaids[i];
 			/*
 			 * We use the navaid into the signal estimation only
 			 * when there is a tone on the frequency.
 			 */
-			if (rnav->audio_chunks[rnav->cur_audio_chunk[stream_id]]
-			    != 0) {
-				max_db = MAX(max_db, rnav->signal_db);
-				tone_db = MAX(tone_db, rnav->signal_db);
+			if (audio_navaid_tone_on(anav, chunk_ctr)) {
+				max_db = MAX(max_db, anav->signal_db);
+				tone_db = MAX(tone_db, anav->signal_db);
 			}
-			max_signal_db = MAX(max_signal_db, rnav->signal_db);
+			max_signal_db = MAX(max_signal_db, anav->signal_db);
 		}
 	} else {
 		const vect2_t vol_curve[] = {
@@ -3324,13 +4630,12 @@ get_audio_buf_type(radio_t *radio, avl_tree_t *tree, double volume,
 		max_signal_db = fx_lin_multi(volume, vol_curve, B_TRUE);
 	}
 
-	if (squelch && tone_db <= NOISE_FLOOR_NAV_ID) {
-		mutex_exit(&radio->lock);
-		return (buf);
-	}
+	if (squelch && tone_db <= NOISE_FLOOR_NAV_ID)
+		return;
 
 	if (radio->type == NAVRAD_TYPE_ADF) {
-		if (radio_adf_is_ant_mode(radio))
+		if (snap->adf_mode == ADF_MODE_ANT ||
+		    snap->adf_mode == ADF_MODE_ANT_BFO)
 			noise_level_db = NOISE_LEVEL_AUDIO - 10;
 		else
 			noise_level_db = NOISE_LEVEL_AUDIO;
@@ -3342,69 +4647,87 @@ get_audio_buf_type(radio_t *radio, avl_tree_t *tree, double volume,
 	noise_level = (noise_level_db - NOISE_FLOOR_AUDIO) / span;
 
 	if (radio->type == NAVRAD_TYPE_ADF &&
-	    (radio->adf_mode == ADF_MODE_ADF_BFO ||
-	    radio->adf_mode == ADF_MODE_ANT_BFO)) {
-		bfo_tones_generate(tree, buf, step, num_samples,
-		    noise_level_db, max_signal_db, stream_id, tone);
+	    (snap->adf_mode == ADF_MODE_ADF_BFO ||
+	    snap->adf_mode == ADF_MODE_ANT_BFO)) {
+		bfo_tones_generate(snap, buf, step, num_samples,
+		    noise_level_db, max_signal_db, chunk_ctr, tone);
 	} else {
-		am_tones_generate(tree, buf, step, num_samples, span,
-		    stream_id, tone);
-	}
-	for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-	    rnav = AVL_NEXT(tree, rnav)) {
-		rnav->cur_audio_chunk[stream_id]++;
-		if (rnav->cur_audio_chunk[stream_id] >=
-		    AUDIO_BUF_NUM_CHUNKS) {
-			rnav->cur_audio_chunk[stream_id] = 0;
-		}
+		am_tones_generate(snap, buf, step, num_samples, span,
+		    chunk_ctr, tone);
 	}
 
 	distort(distort_ctx, buf, num_samples, POW2(volume),
 	    POW2(noise_level * volume));
+}
 
-	mutex_exit(&radio->lock);
-
-	return (buf);
+/*
+ * Returns the number of samples in a single audio chunk of a radio of
+ * type `type', i.e. how many samples navrad_render_audio produces.
+ */
+size_t
+navrad_get_audio_num_samples(navrad_type_t type)
+{
+	CTASSERT(VOR_BUF_NUM_SAMPLES <= NAVRAD_AUDIO_MAX_SAMPLES);
+	CTASSERT(DME_BUF_NUM_SAMPLES <= NAVRAD_AUDIO_MAX_SAMPLES);
+	return (type != NAVRAD_TYPE_DME ? VOR_BUF_NUM_SAMPLES :
+	    DME_BUF_NUM_SAMPLES);
 }
 
-int16_t *
-navrad_get_audio_buf2(navrad_type_t type, unsigned nr, double volume,
-    bool_t squelch, bool_t agc, unsigned stream_id, size_t *num_samples)
+/*
+ * Renders the next audio chunk of a radio into the caller's buffer
+ * `buf', which must have room for at least `cap' samples. Returns the
+ * number of samples written, which is navrad_get_audio_num_samples(),
+ * or 0 if the radio doesn't exist, has failed or `buf' is too small.
+ */
+size_t
+navrad_render_audio(navrad_type_t type, unsigned nr, double volume,
+    bool_t squelch, bool_t agc, unsigned stream_id, int16_t *buf, size_t cap)
 {
-	radio_t *radio = find_radio(type, nr);
+	radio_t *radio;
 	bool_t is_dme = (type == NAVRAD_TYPE_DME ? B_TRUE : B_FALSE);
-	size_t samples = (!is_dme ? VOR_BUF_NUM_SAMPLES : DME_BUF_NUM_SAMPLES);
+	size_t samples = navrad_get_audio_num_samples(type);
 	size_t step = (!is_dme ? VOR_TONE_NUM_SAMPLES : DME_TONE_NUM_SAMPLES);
-	avl_tree_t *tree;
-	int16_t *buf;
-	const int16_t *tone = (!is_dme ? dme_tone : vor_tone);
+	const int16_t *tone = (!is_dme ? vor_tone : dme_tone);
 	distort_t *distort;
+	audio_snap_t snap;
 
 	ASSERT3U(stream_id, <, NAVRAD_MAX_STREAMS);
-	ASSERT(num_samples != NULL);
+	ASSERT(buf != NULL);
 
-	if (radio->failed) {
-		*num_samples = 0;
-		return (NULL);
-	}
-	switch (type) {
-	case NAVRAD_TYPE_VLOC:
-		tree = &radio->vlocs;
-		break;
-	case NAVRAD_TYPE_DME:
-		tree = &radio->dmes;
-		break;
-	default:
-		ASSERT3U(type, ==, NAVRAD_TYPE_ADF);
-		tree = &radio->adfs;
-		break;
+	if (cap < samples)
+		return (0);
+	radio = radio_lookup_hold(type, nr);
+	if (radio == NULL)
+		return (0);
+	radio_audio_snap_read(radio, &snap);
+	if (snap.failed) {
+		radio_rele(radio);
+		return (0);
 	}
 	distort = (!is_dme ? radio->distort_vloc[stream_id] :
 	    radio->distort_dme[stream_id]);
-	buf = get_audio_buf_type(radio, tree, volume, tone, step, samples,
+	render_audio_type(radio, &snap, volume, tone, step, buf, samples,
 	    squelch, agc, distort, stream_id);
+	radio_rele(radio);
+
+	return (samples);
+}
+
+int16_t *
+navrad_get_audio_buf2(navrad_type_t type, unsigned nr, double volume,
+    bool_t squelch, bool_t agc, unsigned stream_id, size_t *num_samples)
+{
+	size_t cap = navrad_get_audio_num_samples(type);
+	int16_t *buf = safe_malloc(cap * sizeof (*buf));
 
-	*num_samples = samples;
+	ASSERT(num_samples != NULL);
+
+	*num_samples = navrad_render_audio(type, nr, volume, squelch, agc,
+	    stream_id, buf, cap);
+	if (*num_samples == 0) {
+		free(buf);
+		return (NULL);
+	}
 	return (buf);
 }
 
@@ -3425,42 +4748,32 @@ navrad_free_audio_buf(int16_t *buf)
 void
 navrad_done_audio(unsigned nr)
 {
-	ASSERT3U(nr, <, NUM_NAV_RADIOS);
+	radio_t *radio = radio_lookup_hold(NAVRAD_TYPE_VLOC, nr);
+
+	if (radio == NULL)
+		return;
 	for (unsigned i = 0; i < NAVRAD_MAX_STREAMS; i++) {
-		distort_clear_buffers(navrad.vloc_radios[nr].distort_vloc[i]);
-		distort_clear_buffers(navrad.vloc_radios[nr].distort_dme[i]);
+		distort_clear_buffers(radio->distort_vloc[i]);
+		distort_clear_buffers(radio->distort_dme[i]);
 	}
+	radio_rele(radio);
 }
 
 void
 navrad_sync_streams(navrad_type_t type, unsigned nr)
 {
-	radio_t *radio = find_radio(type, nr);
-	const avl_tree_t *tree;
-
-	ASSERT(radio != NULL);
+	radio_t *radio = radio_lookup_hold(type, nr);
+	unsigned ctr;
 
-	switch (type) {
-	case NAVRAD_TYPE_VLOC:
-		tree = &radio->vlocs;
-		break;
-	case NAVRAD_TYPE_DME:
-		tree = &radio->dmes;
-		break;
-	default:
-		ASSERT3U(type, ==, NAVRAD_TYPE_ADF);
-		tree = &radio->adfs;
-		break;
-	}
-	mutex_enter(&radio->lock);
-	for (radio_navaid_t *rnav = avl_first(tree); rnav != NULL;
-	    rnav = AVL_NEXT(tree, rnav)) {
-		for (unsigned i = 1; i < ARRAY_NUM_ELEM(rnav->cur_audio_chunk);
-		    i++) {
-			rnav->cur_audio_chunk[i] = rnav->cur_audio_chunk[0];
-		}
+	if (radio == NULL)
+		return;
+	ctr = atomic_load_explicit(&radio->audio_chunk_ctr[0],
+	    memory_order_relaxed);
+	for (unsigned i = 1; i < NAVRAD_MAX_STREAMS; i++) {
+		atomic_store_explicit(&radio->audio_chunk_ctr[i], ctr,
+		    memory_order_relaxed);
 	}
-	mutex_exit(&radio->lock);
+	radio_rele(radio);
 }
 
 void
@@ -3477,60 +4790,182 @@ navrad_get_brg_override(navrad_type_t type, unsigned nr)
 	return (radio->brg_override);
 }
 
+/*
+ * Returns the entry backing a failure slot, creating it if necessary,
+ * or NULL if the slot is beyond NAVAID_FAIL_MAX_SLOTS.
+ * Must be called with navaid_fail.lock held.
+ */
+static navaid_fail_t *
+navaid_fail_slot(unsigned slot)
+{
+	if (slot >= NAVAID_FAIL_MAX_SLOTS)
+		return (NULL);
+	if (slot >= navaid_fail.num_slots) {
+		navaid_fail.slots = safe_realloc(navaid_fail.slots,
+		    (slot + 1) * sizeof (*navaid_fail.slots));
+		for (unsigned i = navaid_fail.num_slots; i <= slot; i++) {
+			navaid_fail.slots[i] = safe_calloc(1,
+			    sizeof (navaid_fail_t));
+			navaid_fail.slots[i]->is_slot = B_TRUE;
+		}
+		navaid_fail.num_slots = slot + 1;
+	}
+	return (navaid_fail.slots[slot]);
+}
+
 void
 navrad_set_navaid_fail_ID(unsigned slot, const char *name)
 {
-	ASSERT3U(slot, <, NUM_NAVAID_FAILS);
+	navaid_fail_t *fail;
+
 	mutex_enter(&navaid_fail.lock);
-	if (name != NULL) {
-		strlcpy(navaid_fail.ID[slot], name,
-		    sizeof (navaid_fail.ID[slot]));
-		strtoupper(navaid_fail.ID[slot]);
+	fail = navaid_fail_slot(slot);
+	if (fail == NULL) {
+		mutex_exit(&navaid_fail.lock);
+		return;
+	}
+	navaid_fail_unhash(fail);
+	if (name != NULL && navaid_fail_key(name, fail->ID)) {
+		strtoupper(fail->ID);
+		navaid_fail_hash(fail);
 	} else {
-		navaid_fail.ID[slot][0] = '\0';
+		fail->ID[0] = '\0';
 	}
+	navaid_fail_changed();
 	mutex_exit(&navaid_fail.lock);
 }
 
 void
 navrad_set_navaid_fail_type(unsigned slot, navaid_type_t type)
 {
-	ASSERT3U(slot, <, NUM_NAVAID_FAILS);
+	navaid_fail_t *fail;
+
 	mutex_enter(&navaid_fail.lock);
-	navaid_fail.type[slot] = type;
+	fail = navaid_fail_slot(slot);
+	if (fail != NULL) {
+		fail->type = type;
+		navaid_fail_changed();
+	}
 	mutex_exit(&navaid_fail.lock);
 }
 
 void
 navrad_set_navaid_fail_state(unsigned slot, bool_t failed)
 {
-	ASSERT3U(slot, <, NUM_NAVAID_FAILS);
+	navaid_fail_t *fail;
+
 	mutex_enter(&navaid_fail.lock);
-	navaid_fail.failed[slot] = failed;
+	fail = navaid_fail_slot(slot);
+	if (fail != NULL) {
+		fail->failed = failed;
+		navaid_fail_changed();
+	}
 	mutex_exit(&navaid_fail.lock);
 }
 
 void
 navrad_get_navaid_fail_ID(unsigned slot, char *buf, size_t cap)
 {
-	ASSERT3U(slot, <, NUM_NAVAID_FAILS);
 	ASSERT(buf != NULL || cap == 0);
 
 	mutex_enter(&navaid_fail.lock);
-	strlcpy(buf, navaid_fail.ID[slot], cap);
+	if (slot < navaid_fail.num_slots)
+		strlcpy(buf, navaid_fail.slots[slot]->ID, cap);
+	else if (cap != 0)
+		buf[0] = '\0';
 	mutex_exit(&navaid_fail.lock);
 }
 
 navaid_type_t
 navrad_get_navaid_fail_type(unsigned slot)
 {
-	ASSERT3U(slot, <, NUM_NAVAID_FAILS);
-	return (navaid_fail.type[slot]);
+	navaid_type_t type = 0;
+
+	mutex_enter(&navaid_fail.lock);
+	if (slot < navaid_fail.num_slots)
+		type = navaid_fail.slots[slot]->type;
+	mutex_exit(&navaid_fail.lock);
+
+	return (type);
 }
 
 bool_t
 navrad_get_navaid_fail_state(unsigned slot)
 {
-	ASSERT3U(slot, <, NUM_NAVAID_FAILS);
-	return (navaid_fail.failed[slot]);
+	bool_t failed = B_FALSE;
+
+	mutex_enter(&navaid_fail.lock);
+	if (slot < navaid_fail.num_slots)
+		failed = navaid_fail.slots[slot]->failed;
+	mutex_exit(&navaid_fail.lock);
+
+	return (failed);
+}
+
+void
+navrad_set_navaid_failed(const char *ID, navaid_type_t type, bool_t failed)
+{
+	char key[NAVAID_FAIL_ID_LEN];
+	navaid_fail_t *fail = NULL;
+	const list_t *l;
+
+	ASSERT(ID != NULL);
+	if (!navaid_fail_key(ID, key) || key[0] == '\0')
+		return;
+	strtoupper(key);
+
+	mutex_enter(&navaid_fail.lock);
+	l = htbl_lookup_multi(&navaid_fail.by_id, key);
+	if (l != NULL) {
+		for (void *v = list_head(l); v != NULL; v = list_next(l, v)) {
+			navaid_fail_t *f = HTBL_VALUE_MULTI(v);
+
+			if (!f->is_slot && f->type == type) {
+				fail = f;
+				break;
+			}
+		}
+	}
+	if (failed && fail == NULL) {
+		fail = safe_calloc(1, sizeof (*fail));
+		memcpy(fail->ID, key, sizeof (fail->ID));
+		fail->type = type;
+		fail->failed = B_TRUE;
+		navaid_fail_hash(fail);
+		list_insert_tail(&navaid_fail.direct, fail);
+		navaid_fail_changed();
+	} else if (!failed && fail != NULL) {
+		navaid_fail_unhash(fail);
+		list_remove(&navaid_fail.direct, fail);
+		free(fail);
+		navaid_fail_changed();
+	}
+	mutex_exit(&navaid_fail.lock);
+}
+
+bool_t
+navrad_get_navaid_failed(const char *ID, navaid_type_t type)
+{
+	char key[NAVAID_FAIL_ID_LEN];
+
+	ASSERT(ID != NULL);
+	if (!navaid_fail_key(ID, key))
+		return (B_FALSE);
+	strtoupper(key);
+
+	return (navaid_is_failed(key, type));
+}
+
+void
+navrad_clear_navaid_fails(void)
+{
+	navaid_fail_t *fail;
+
+	mutex_enter(&navaid_fail.lock);
+	while ((fail = list_remove_head(&navaid_fail.direct)) != NULL) {
+		navaid_fail_unhash(fail);
+		free(fail);
+	}
+	navaid_fail_changed();
+	mutex_exit(&navaid_fail.lock);
 }
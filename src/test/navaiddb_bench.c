@@ -0,0 +1,593 @@
+/*
+ * CDDL HEADER START
+ *
+ * This file and its contents are supplied under the terms of the
+ * Common Development and Distribution License ("CDDL"), version 1.0.
+ * You may only use this file in accordance with the terms of version
+ * 1.0 of the CDDL.
+ *
+ * A full copy of the text of the CDDL should have accompanied this
+ * source.  A copy of the CDDL is also available via the Internet at
+ * http://www.illumos.org/license/CDDL.
+ *
+ * CDDL HEADER END
+*/
+/*
+ * Copyright 2026 Saso Kiselkov. All rights reserved.
+ */
+
+/*
+ * Standalone navaiddb benchmark. Generates a synthetic X-Plane directory
+ * containing a "default data/earth_nav.dat" file and measures how long
+ * the database takes to parse, to write out to and load back from the
+ * cache, how large it is and the latency distribution of radius,
+ * frequency and identifier queries against it.
+ *
+ * The generated navaids are a mix of uniformly scattered stations,
+ * dense clusters (think Central Europe or the US north-east), stations
+ * close to the poles, exact duplicates and near-duplicate localizers at
+ * the same airport, which exercise the parser's de-duplication logic.
+ * All randomness comes from a seeded PRNG, so runs are reproducible.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if	IBM
+#include <windows.h>
+#else	/* !IBM */
+#include <sys/resource.h>
+#endif	/* !IBM */
+
+#include <XPLMGraphics.h>
+#include <XPLMScenery.h>
+
+#include <acfutils/airportdb.h>
+#include <acfutils/crc64.h>
+#include <acfutils/helpers.h>
+#include <acfutils/log.h>
+#include <acfutils/safe_alloc.h>
+
+#include "../libradio/navaiddb.h"
+
+#define	BENCH_RADIUS	NM2MET(300)
+#define	MAX_CLUSTERS	64
+
+typedef struct {
+	navaid_type_t	type;
+	double		lat;
+	double		lon;
+	uint64_t	freq;		/* Hz */
+	char		id[8];
+} gen_navaid_t;
+
+static struct {
+	unsigned	num_navaids;
+	unsigned	num_clusters;
+	double		cluster_fract;
+	double		polar_fract;
+	double		dup_fract;
+	unsigned	num_queries;
+	uint64_t	seed;
+	const char	*dir;
+	bool_t		keep;
+} opts = {
+	.num_navaids = 100000,
+	.num_clusters = 8,
+	.cluster_fract = 0.3,
+	.polar_fract = 0.02,
+	.dup_fract = 0.02,
+	.num_queries = 10000,
+	.seed = 1
+};
+
+static uint64_t rng_state;
+static gen_navaid_t *gen_navaids = NULL;
+static unsigned num_gen_navaids = 0;
+static geo_pos2_t clusters[MAX_CLUSTERS];
+
+/*
+ * navaiddb_get_xp_elev is never called here, but navaiddb.c references
+ * the XPLM terrain probe API, which we don't have outside of X-Plane.
+ */
+XPLMProbeRef
+XPLMCreateProbe(XPLMProbeType type)
+{
+	UNUSED(type);
+	return (NULL);
+}
+
+void
+XPLMDestroyProbe(XPLMProbeRef probe)
+{
+	UNUSED(probe);
+}
+
+XPLMProbeResult
+XPLMProbeTerrainXYZ(XPLMProbeRef probe, float x, float y, float z,
+    XPLMProbeInfo_t *info)
+{
+	UNUSED(probe);
+	UNUSED(x);
+	UNUSED(y);
+	UNUSED(z);
+	UNUSED(info);
+	return (xplm_ProbeError);
+}
+
+void
+XPLMWorldToLocal(double lat, double lon, double elev, double *x, double *y,
+    double *z)
+{
+	*x = lon;
+	*y = elev;
+	*z = lat;
+}
+
+void
+XPLMLocalToWorld(double x, double y, double z, double *lat, double *lon,
+    double *elev)
+{
+	*lat = z;
+	*lon = x;
+	*elev = y;
+}
+
+static void
+log_stderr(const char *str)
+{
+	fputs(str, stderr);
+}
+
+/* xorshift64*, so that the output doesn't depend on the libc */
+static uint64_t
+rng(void)
+{
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return (rng_state * 0x2545F4914F6CDD1Dull);
+}
+
+static double
+rng_uniform(double min, double max)
+{
+	return (min + (max - min) * ((rng() >> 11) / (double)(1ull << 53)));
+}
+
+static unsigned
+rng_idx(unsigned n)
+{
+	return (rng() % n);
+}
+
+static double
+rng_gauss(double sigma)
+{
+	double u1 = rng_uniform(1e-12, 1), u2 = rng_uniform(0, 1);
+
+	return (sigma * sqrt(-2 * log(u1)) * cos(2 * M_PI * u2));
+}
+
+static uint64_t
+nanotime(void)
+{
+#if	IBM
+	LARGE_INTEGER freq, cnt;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&cnt);
+	return ((cnt.QuadPart / freq.QuadPart) * 1000000000ull +
+	    ((cnt.QuadPart % freq.QuadPart) * 1000000000ull) / freq.QuadPart);
+#else	/* !IBM */
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000ull + ts.tv_nsec);
+#endif	/* !IBM */
+}
+
+static geo_pos2_t
+gen_pos(void)
+{
+	double x = rng_uniform(0, 1);
+
+	if (x < opts.polar_fract) {
+		/* within 5 degrees of either pole */
+		double lat = rng_uniform(85, 90);
+
+		return (GEO_POS2(rng_idx(2) ? lat : -lat,
+		    rng_uniform(-180, 180)));
+	}
+	if (x < opts.polar_fract + opts.cluster_fract &&
+	    opts.num_clusters != 0) {
+		geo_pos2_t c = clusters[rng_idx(opts.num_clusters)];
+		double lat = clamp(c.lat + rng_gauss(1.5), -89.9, 89.9);
+		double lon = c.lon + rng_gauss(2);
+
+		if (lon < -180)
+			lon += 360;
+		else if (lon >= 180)
+			lon -= 360;
+		return (GEO_POS2(lat, lon));
+	}
+	/* uniform on the sphere */
+	return (GEO_POS2(RAD2DEG(asin(rng_uniform(-1, 1))),
+	    rng_uniform(-180, 180)));
+}
+
+static void
+gen_id(char *id, unsigned len)
+{
+	for (unsigned i = 0; i < len; i++)
+		id[i] = 'A' + rng_idx(26);
+	id[len] = '\0';
+}
+
+static void
+gen_record(navaid_type_t type, double lat, double lon, uint64_t freq,
+    const char *id)
+{
+	gen_navaid_t *gn = &gen_navaids[num_gen_navaids++];
+
+	gn->type = type;
+	gn->lat = lat;
+	gn->lon = lon;
+	gn->freq = freq;
+	strlcpy(gn->id, id, sizeof (gn->id));
+}
+
+/*
+ * Writes a single navaid (or a localizer with its glideslope, DME and
+ * markers) to `fp'. Frequencies are drawn from small sets, so that the
+ * clusters end up with lots of same-frequency stations.
+ */
+static void
+gen_navaid(FILE *fp)
+{
+	geo_pos2_t p = gen_pos();
+	int elev = rng_idx(3000);
+	char id[8], icao[8], rwy[8];
+	unsigned kind = rng_idx(100);
+
+	if (kind < 30) {
+		unsigned khz = 190 + 5 * rng_idx(100);
+
+		gen_id(id, 2 + rng_idx(2));
+		fprintf(fp, "2 %.8f %.8f %d %u 50 0.0 %s ENRT ZZ %s NDB\n",
+		    p.lat, p.lon, elev, khz, id, id);
+		gen_record(NAVAID_NDB, p.lat, p.lon, khz * 1000ull, id);
+	} else if (kind < 55) {
+		/* 112.00 - 117.95 MHz */
+		unsigned f10k = 11200 + 5 * rng_idx(120);
+
+		gen_id(id, 3);
+		fprintf(fp, "3 %.8f %.8f %d %u 130 %.1f %s ENRT ZZ %s "
+		    "VOR/DME\n", p.lat, p.lon, elev, f10k,
+		    rng_uniform(-20, 20), id, id);
+		fprintf(fp, "12 %.8f %.8f %d %u 130 0.000 %s ENRT ZZ %s "
+		    "VOR/DME DME\n", p.lat, p.lon, elev, f10k, id, id);
+		gen_record(NAVAID_VOR, p.lat, p.lon, f10k * 10000ull, id);
+		gen_record(NAVAID_DME, p.lat, p.lon, f10k * 10000ull, id);
+	} else {
+		/* odd tenths, 108.10 - 111.95 MHz */
+		unsigned f10k = 10810 + 20 * rng_idx(20) + 5 * rng_idx(2);
+		double brg = rng_uniform(0, 360);
+		geo_pos2_t gs_p = GEO_POS2(p.lat + 0.01, p.lon);
+		int reps = 1;
+
+		gen_id(id + 1, 3);
+		id[0] = 'I';
+		snprintf(icao, sizeof (icao), "K%c%c%c", 'A' + rng_idx(26),
+		    'A' + rng_idx(26), 'A' + rng_idx(26));
+		snprintf(rwy, sizeof (rwy), "%02d", 1 + (int)(brg / 10) % 36);
+		/*
+		 * Near-duplicate localizer at the same airport under a
+		 * different identifier, like an outdated hand-placed one.
+		 */
+		if (rng_uniform(0, 1) < opts.dup_fract)
+			reps = 2;
+		for (int i = 0; i < reps; i++) {
+			double d = i * 0.001;
+
+			fprintf(fp, "4 %.8f %.8f %d %u 18 %.3f %s %s ZZ %s "
+			    "ILS-cat-I\n", p.lat + d, p.lon, elev, f10k,
+			    brg + i, id, icao, rwy);
+			gen_record(NAVAID_LOC, p.lat + d, p.lon,
+			    f10k * 10000ull, id);
+			id[1] = (id[1] == 'Z' ? 'A' : id[1] + 1);
+		}
+		fprintf(fp, "6 %.8f %.8f %d %u 10 300%07.3f %s %s ZZ %s GS\n",
+		    gs_p.lat, gs_p.lon, elev, f10k, brg, id, icao, rwy);
+		fprintf(fp, "12 %.8f %.8f %d %u 18 0.000 %s %s ZZ %s "
+		    "DME-ILS\n", gs_p.lat, gs_p.lon, elev, f10k, id, icao, rwy);
+		fprintf(fp, "8 %.8f %.8f %d 0 0 %.3f ---- %s ZZ %s MM\n",
+		    p.lat - 0.01, p.lon, elev, brg, icao, rwy);
+		gen_record(NAVAID_GS, gs_p.lat, gs_p.lon, f10k * 10000ull, id);
+		gen_record(NAVAID_DME, gs_p.lat, gs_p.lon, f10k * 10000ull, id);
+	}
+}
+
+static bool_t
+gen_earth_nav(const char *path)
+{
+	FILE *fp = fopen(path, "wb");
+	unsigned n_written = 0;
+
+	if (fp == NULL) {
+		fprintf(stderr, "Can't write %s\n", path);
+		return (B_FALSE);
+	}
+	/* A localizer produces up to 7 records */
+	gen_navaids = safe_calloc(opts.num_navaids + 8,
+	    sizeof (*gen_navaids));
+	for (unsigned i = 0; i < opts.num_clusters; i++) {
+		clusters[i] = GEO_POS2(rng_uniform(-60, 70),
+		    rng_uniform(-180, 180));
+	}
+	fprintf(fp, "I\n1100 Version - synthetic navaiddb_bench data, "
+	    "seed %llu\n\n", (unsigned long long)opts.seed);
+	while (num_gen_navaids < opts.num_navaids) {
+		const gen_navaid_t *gn;
+
+		gen_navaid(fp);
+		n_written++;
+		/* Exact duplicates, which must be dropped by the parser */
+		gn = &gen_navaids[num_gen_navaids - 1];
+		if (gn->type == NAVAID_NDB &&
+		    rng_uniform(0, 1) < opts.dup_fract) {
+			fprintf(fp, "2 %.8f %.8f 0 %u 50 0.0 %s ENRT ZZ %s "
+			    "NDB\n", gn->lat, gn->lon,
+			    (unsigned)(gn->freq / 1000), gn->id, gn->id);
+		}
+	}
+	fprintf(fp, "99\n");
+	if (fclose(fp) != 0) {
+		fprintf(stderr, "Error writing %s\n", path);
+		return (B_FALSE);
+	}
+	printf("generated: %u records from %u stations in %s\n",
+	    num_gen_navaids, n_written, path);
+
+	return (B_TRUE);
+}
+
+static int
+u64_compar(const void *a, const void *b)
+{
+	uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+
+	if (ua < ub)
+		return (-1);
+	if (ua > ub)
+		return (1);
+	return (0);
+}
+
+static void
+report_latency(const char *name, uint64_t *lat, unsigned n, size_t results)
+{
+	qsort(lat, n, sizeof (*lat), u64_compar);
+	printf("%-8s p50: %9.3f us  p99: %9.3f us  max: %9.3f us  "
+	    "avg results: %.1f\n", name, lat[n / 2] / 1000.0,
+	    lat[(n * 99) / 100] / 1000.0, lat[n - 1] / 1000.0,
+	    results / (double)n);
+}
+
+/*
+ * Half of the query positions are uniformly distributed, the other half
+ * is in the clusters, where the queries are the most expensive.
+ */
+static geo_pos2_t
+query_pos(unsigned i)
+{
+	if (i % 2 == 0 || opts.num_clusters == 0) {
+		return (GEO_POS2(RAD2DEG(asin(rng_uniform(-1, 1))),
+		    rng_uniform(-180, 180)));
+	}
+	return (clusters[rng_idx(opts.num_clusters)]);
+}
+
+static void
+bench_queries(navaiddb_t *db)
+{
+	uint64_t *lat = safe_calloc(opts.num_queries, sizeof (*lat));
+	navaid_list_t list = {};
+	navaid_type_t type = NAVAID_VOR | NAVAID_DME;
+	size_t results = 0;
+
+	/* radius queries, as done when browsing the map */
+	for (unsigned i = 0; i < opts.num_queries; i++) {
+		geo_pos2_t pos = query_pos(i);
+		uint64_t t0 = nanotime();
+
+		navaiddb_query_list(db, pos, BENCH_RADIUS, NULL, NULL, &type,
+		    &list);
+		lat[i] = nanotime() - t0;
+		results += list.num_navaids;
+	}
+	report_latency("radius", lat, opts.num_queries, results);
+
+	/* frequency queries, as done by the radio worker */
+	results = 0;
+	for (unsigned i = 0; i < opts.num_queries; i++) {
+		const gen_navaid_t *gn =
+		    &gen_navaids[rng_idx(num_gen_navaids)];
+		geo_pos2_t pos = GEO_POS2(gn->lat, gn->lon);
+		uint64_t freq = gn->freq;
+		uint64_t t0 = nanotime();
+
+		navaiddb_query_list(db, pos, BENCH_RADIUS, NULL, &freq, NULL,
+		    &list);
+		lat[i] = nanotime() - t0;
+		results += list.num_navaids;
+	}
+	report_latency("freq", lat, opts.num_queries, results);
+
+	/* identifier lookups */
+	results = 0;
+	for (unsigned i = 0; i < opts.num_queries; i++) {
+		const gen_navaid_t *gn =
+		    &gen_navaids[rng_idx(num_gen_navaids)];
+		uint64_t t0 = nanotime();
+
+		results += navaiddb_lookup_id(db, gn->id, NULL, NULL, NULL,
+		    &list);
+		lat[i] = nanotime() - t0;
+	}
+	report_latency("ident", lat, opts.num_queries, results);
+
+	navaiddb_list_fini(&list);
+	free(lat);
+}
+
+static void
+usage(const char *progname)
+{
+	fprintf(stderr, "Usage: %s [-n <navaids>] [-c <clusters>] "
+	    "[-f <cluster fraction>]\n"
+	    "    [-p <polar fraction>] [-d <duplicate fraction>] "
+	    "[-q <queries>] [-s <seed>]\n"
+	    "    [-k] <workdir>\n"
+	    "The synthetic X-Plane directory is created in a new directory\n"
+	    "named navaiddb_bench.<pid> inside of <workdir>. Pass -k to keep\n"
+	    "it after the benchmark.\n", progname);
+}
+
+int
+main(int argc, char **argv)
+{
+	int opt;
+	char *xpdir, *navdir, *navpath, *cachedir;
+	char subdir[32];
+	airportdb_t adb = {};
+	navaiddb_t *db;
+	uint64_t t0;
+	int ret = 1;
+
+	while ((opt = getopt(argc, argv, "n:c:f:p:d:q:s:kh")) != -1) {
+		switch (opt) {
+		case 'n':
+			opts.num_navaids = MAX(atoi(optarg), 1);
+			break;
+		case 'c':
+			opts.num_clusters = clampi(atoi(optarg), 0,
+			    MAX_CLUSTERS);
+			break;
+		case 'f':
+			opts.cluster_fract = clamp(atof(optarg), 0, 1);
+			break;
+		case 'p':
+			opts.polar_fract = clamp(atof(optarg), 0, 1);
+			break;
+		case 'd':
+			opts.dup_fract = clamp(atof(optarg), 0, 1);
+			break;
+		case 'q':
+			opts.num_queries = MAX(atoi(optarg), 1);
+			break;
+		case 's':
+			opts.seed = strtoull(optarg, NULL, 0);
+			break;
+		case 'k':
+			opts.keep = B_TRUE;
+			break;
+		default:
+			usage(argv[0]);
+			return (opt == 'h' ? 0 : 1);
+		}
+	}
+	if (optind + 1 != argc) {
+		usage(argv[0]);
+		return (1);
+	}
+	opts.dir = argv[optind];
+	rng_state = (opts.seed != 0 ? opts.seed : 1);
+
+	log_init(log_stderr, "navaiddb_bench");
+	crc64_init();
+
+	/*
+	 * Everything we create goes into a private subdirectory, which is
+	 * the only thing we ever delete.
+	 */
+#if	IBM
+	snprintf(subdir, sizeof (subdir), "navaiddb_bench.%lu",
+	    (unsigned long)GetCurrentProcessId());
+#else
+	snprintf(subdir, sizeof (subdir), "navaiddb_bench.%lu",
+	    (unsigned long)getpid());
+#endif
+	xpdir = mkpathname(opts.dir, subdir, NULL);
+	if (file_exists(xpdir, NULL)) {
+		fprintf(stderr, "%s already exists, refusing to use it\n",
+		    xpdir);
+		lacf_free(xpdir);
+		return (1);
+	}
+	navdir = mkpathname(xpdir, "Resources", "default data", NULL);
+	navpath = mkpathname(navdir, "earth_nav.dat", NULL);
+	cachedir = mkpathname(xpdir, "cache", NULL);
+	if (!create_directory_recursive(navdir) || !gen_earth_nav(navpath))
+		goto out;
+	/* no apt.dat, so localizers simply won't find their runways */
+	airportdb_create(&adb, xpdir, cachedir);
+
+	t0 = nanotime();
+	db = navaiddb_create(xpdir, &adb);
+	if (db == NULL) {
+		fprintf(stderr, "navaiddb_create failed\n");
+		goto out;
+	}
+	printf("parse:        %9.1f ms\n", (nanotime() - t0) / 1000000.0);
+	printf("navaids:      %9zu\n", navaiddb_get_num_navaids(db));
+	printf("image size:   %9.1f MiB (%.1f bytes/navaid)\n",
+	    navaiddb_get_size(db) / 1048576.0,
+	    navaiddb_get_size(db) / (double)navaiddb_get_num_navaids(db));
+#if	!IBM
+	{
+		struct rusage ru;
+
+		getrusage(RUSAGE_SELF, &ru);
+		printf("max RSS:      %9.1f MiB\n", ru.ru_maxrss /
+#if	APL
+		    1048576.0);	/* bytes on macOS */
+#else
+		    1024.0);	/* KiB on Linux */
+#endif
+	}
+#endif	/* !IBM */
+	navaiddb_destroy(db);
+
+	t0 = nanotime();
+	db = navaiddb_create2(xpdir, cachedir, &adb);
+	VERIFY(db != NULL);
+	printf("cache build:  %9.1f ms\n", (nanotime() - t0) / 1000000.0);
+	navaiddb_destroy(db);
+
+	t0 = nanotime();
+	db = navaiddb_create2(xpdir, cachedir, &adb);
+	VERIFY(db != NULL);
+	printf("cache load:   %9.1f ms\n", (nanotime() - t0) / 1000000.0);
+
+	bench_queries(db);
+	navaiddb_destroy(db);
+	airportdb_destroy(&adb);
+	ret = 0;
+out:
+	if (!opts.keep)
+		remove_directory(xpdir);
+	else
+		printf("kept %s\n", xpdir);
+	lacf_free(xpdir);
+	lacf_free(navdir);
+	lacf_free(navpath);
+	lacf_free(cachedir);
+	free(gen_navaids);
+
+	return (ret);
+}